@@ -0,0 +1,543 @@
+#include <benchmark/benchmark.h>
+
+#include "../src/stream.h"
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+#if defined(__cpp_lib_ranges)
+#include <ranges>
+#define CPPSTREAM_BENCH_RANGES 1
+#endif
+
+// Every case is measured three times: through a Stream ("Stream"), as a hand-written loop ("Loop")
+// and as a C++20 ranges pipeline ("Ranges"), so that overhead of the library is visible next to its baselines.
+// Run with --benchmark_format=json or --benchmark_out=<file> --benchmark_out_format=json to track results per commit.
+
+namespace {
+
+using namespace cppstream;
+
+struct Large {
+    std::array<int64_t, 8> values;
+};
+
+template<class T>
+T make_element(int64_t i) {
+    if constexpr (std::is_same<T, Large>::value) {
+        Large large{};
+        large.values.fill(i);
+        return large;
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+int64_t key(int value) { return value; }
+
+int64_t key(double value) { return static_cast<int64_t>(value); }
+
+int64_t key(const Large & value) { return value.values[0]; }
+
+template<class T>
+const std::vector<T> & elements(size_t size) {
+    static std::vector<T> vec;
+    if (vec.size() != size) {
+        vec.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            vec[i] = make_element<T>(static_cast<int64_t>(i % 1000));
+        }
+    }
+    return vec;
+}
+
+class NullBuffer : public std::streambuf {
+protected:
+    int_type overflow(int_type ch) override { return ch; }
+
+    std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+};
+
+auto is_odd = [](const auto & value) { return key(value) % 2 != 0; };
+auto to_key = [](const auto & value) { return key(value); };
+auto increment = [](int64_t value) { return value + 1; };
+
+#define CPPSTREAM_SIZES ->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20)
+
+#define CPPSTREAM_TYPED_BENCHMARK(name) \
+    BENCHMARK_TEMPLATE(name, int) CPPSTREAM_SIZES; \
+    BENCHMARK_TEMPLATE(name, double) CPPSTREAM_SIZES; \
+    BENCHMARK_TEMPLATE(name, Large) CPPSTREAM_SIZES
+
+// Sources
+
+void Source_Container_Stream(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(vec) | sum());
+    }
+}
+
+void Source_View_Stream(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | sum());
+    }
+}
+
+void Source_Container_Loop(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::accumulate(vec.begin(), vec.end(), 0));
+    }
+}
+
+void Source_Pack_Stream(benchmark::State & state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16) | sum());
+    }
+}
+
+void Source_Pack_Loop(benchmark::State & state) {
+    for (auto _ : state) {
+        int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+        benchmark::DoNotOptimize(values);
+        benchmark::DoNotOptimize(std::accumulate(std::begin(values), std::end(values), 0));
+    }
+}
+
+void Source_Infinite_Stream(benchmark::State & state) {
+    size_t size = state.range(0);
+    for (auto _ : state) {
+        int64_t next = 0;
+        benchmark::DoNotOptimize(Stream([&next]() { return next++; }) | get(size) | sum());
+    }
+}
+
+void Source_Infinite_Loop(benchmark::State & state) {
+    size_t size = state.range(0);
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (int64_t next = 0; next < static_cast<int64_t>(size); ++next) {
+            total += next;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+BENCHMARK(Source_Container_Stream) CPPSTREAM_SIZES;
+BENCHMARK(Source_View_Stream) CPPSTREAM_SIZES;
+BENCHMARK(Source_Container_Loop) CPPSTREAM_SIZES;
+BENCHMARK(Source_Pack_Stream);
+BENCHMARK(Source_Pack_Loop);
+BENCHMARK(Source_Infinite_Stream) CPPSTREAM_SIZES;
+BENCHMARK(Source_Infinite_Loop) CPPSTREAM_SIZES;
+
+#ifdef CPPSTREAM_BENCH_RANGES
+
+void Source_Infinite_Ranges(benchmark::State & state) {
+    size_t size = state.range(0);
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (int64_t value : std::views::iota(int64_t(0)) | std::views::take(size)) {
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+BENCHMARK(Source_Infinite_Ranges) CPPSTREAM_SIZES;
+
+#endif
+
+// Stages, each followed by summation of element keys
+
+template<class T>
+void Filter_Stream(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | filter(is_odd) | map(to_key) | sum());
+    }
+}
+
+template<class T>
+void Filter_Loop(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (const T & value : vec) {
+            if (is_odd(value)) {
+                total += key(value);
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+template<class T>
+void Map_Stream(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | map(to_key) | sum());
+    }
+}
+
+template<class T>
+void Map_Loop(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (const T & value : vec) {
+            total += key(value);
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+template<class T>
+void SkipGet_Stream(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    size_t quarter = vec.size() / 4;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | skip(quarter) | get(2 * quarter) | map(to_key) | sum());
+    }
+}
+
+template<class T>
+void SkipGet_Loop(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    size_t quarter = vec.size() / 4;
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (size_t i = quarter; i < 3 * quarter; ++i) {
+            total += key(vec[i]);
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+template<class T>
+void Group_Stream(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | group(8) | map([](const auto & group) {
+            return key(group.front());
+        }) | sum());
+    }
+}
+
+template<class T>
+void Group_Loop(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (size_t i = 0; i < vec.size(); i += 8) {
+            total += key(vec[i]);
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+CPPSTREAM_TYPED_BENCHMARK(Filter_Stream);
+CPPSTREAM_TYPED_BENCHMARK(Filter_Loop);
+CPPSTREAM_TYPED_BENCHMARK(Map_Stream);
+CPPSTREAM_TYPED_BENCHMARK(Map_Loop);
+CPPSTREAM_TYPED_BENCHMARK(SkipGet_Stream);
+CPPSTREAM_TYPED_BENCHMARK(SkipGet_Loop);
+CPPSTREAM_TYPED_BENCHMARK(Group_Stream);
+CPPSTREAM_TYPED_BENCHMARK(Group_Loop);
+
+#ifdef CPPSTREAM_BENCH_RANGES
+
+template<class T>
+void Filter_Ranges(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (int64_t value : vec | std::views::filter(is_odd) | std::views::transform(to_key)) {
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+template<class T>
+void Map_Ranges(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (int64_t value : vec | std::views::transform(to_key)) {
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+template<class T>
+void SkipGet_Ranges(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    size_t quarter = vec.size() / 4;
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (int64_t value : vec | std::views::drop(quarter) | std::views::take(2 * quarter)
+                             | std::views::transform(to_key)) {
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+CPPSTREAM_TYPED_BENCHMARK(Filter_Ranges);
+CPPSTREAM_TYPED_BENCHMARK(Map_Ranges);
+CPPSTREAM_TYPED_BENCHMARK(SkipGet_Ranges);
+
+#endif
+
+// Terminals
+
+void Sum_Stream(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | sum());
+    }
+}
+
+void Sum_Loop(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    for (auto _ : state) {
+        int total = 0;
+        for (int value : vec) {
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+template<class T>
+void Reduce_Stream(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | reduce([](const T & first) { return key(first); },
+                                                            [](int64_t acc, const T & value) {
+                                                                return acc ^ key(value);
+                                                            }));
+    }
+}
+
+template<class T>
+void Reduce_Loop(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        int64_t acc = key(vec.front());
+        for (size_t i = 1; i < vec.size(); ++i) {
+            acc ^= key(vec[i]);
+        }
+        benchmark::DoNotOptimize(acc);
+    }
+}
+
+template<class T>
+void Nth_Stream(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | filter(is_odd) | nth(vec.size() / 4));
+    }
+}
+
+template<class T>
+void Nth_Loop(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        size_t remaining = vec.size() / 4;
+        const T * found = nullptr;
+        for (const T & value : vec) {
+            if (is_odd(value) && remaining-- == 0) {
+                found = &value;
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(found);
+    }
+}
+
+template<class T>
+void ToVector_Stream(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Stream(view(vec)) | filter(is_odd) | to_vector());
+    }
+}
+
+template<class T>
+void ToVector_Loop(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        std::vector<T> result;
+        for (const T & value : vec) {
+            if (is_odd(value)) {
+                result.push_back(value);
+            }
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+void PrintTo_Stream(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    NullBuffer buffer;
+    std::ostream os(&buffer);
+    for (auto _ : state) {
+        Stream(view(vec)) | print_to(os);
+    }
+}
+
+void WriteTo_Stream(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    NullBuffer buffer;
+    std::ostream os(&buffer);
+    for (auto _ : state) {
+        Stream(view(vec)) | write_to(os);
+    }
+}
+
+void PrintTo_Loop(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    NullBuffer buffer;
+    std::ostream os(&buffer);
+    for (auto _ : state) {
+        const char * delimiter = "";
+        for (int value : vec) {
+            os << delimiter << value;
+            delimiter = " ";
+        }
+    }
+}
+
+BENCHMARK(Sum_Stream) CPPSTREAM_SIZES;
+BENCHMARK(Sum_Loop) CPPSTREAM_SIZES;
+CPPSTREAM_TYPED_BENCHMARK(Reduce_Stream);
+CPPSTREAM_TYPED_BENCHMARK(Reduce_Loop);
+CPPSTREAM_TYPED_BENCHMARK(Nth_Stream);
+CPPSTREAM_TYPED_BENCHMARK(Nth_Loop);
+CPPSTREAM_TYPED_BENCHMARK(ToVector_Stream);
+CPPSTREAM_TYPED_BENCHMARK(ToVector_Loop);
+BENCHMARK(PrintTo_Stream) CPPSTREAM_SIZES;
+BENCHMARK(WriteTo_Stream) CPPSTREAM_SIZES;
+BENCHMARK(PrintTo_Loop) CPPSTREAM_SIZES;
+
+#ifdef CPPSTREAM_BENCH_RANGES
+
+void Sum_Ranges(benchmark::State & state) {
+    const std::vector<int> & vec = elements<int>(state.range(0));
+    for (auto _ : state) {
+        int total = 0;
+        for (int value : vec | std::views::all) {
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+template<class T>
+void Nth_Ranges(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        auto odd = vec | std::views::filter(is_odd);
+        benchmark::DoNotOptimize(*std::ranges::next(odd.begin(), vec.size() / 4));
+    }
+}
+
+template<class T>
+void ToVector_Ranges(benchmark::State & state) {
+    const std::vector<T> & vec = elements<T>(state.range(0));
+    for (auto _ : state) {
+        auto odd = vec | std::views::filter(is_odd);
+        std::vector<T> result(odd.begin(), odd.end());
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+BENCHMARK(Sum_Ranges) CPPSTREAM_SIZES;
+CPPSTREAM_TYPED_BENCHMARK(Nth_Ranges);
+CPPSTREAM_TYPED_BENCHMARK(ToVector_Ranges);
+
+#endif
+
+// Chains of 1 to 10 map stages
+
+template<size_t Depth, class S>
+auto map_chain(S && stream) {
+    if constexpr (Depth == 0) {
+        return std::forward<S>(stream);
+    } else {
+        return map_chain<Depth - 1>(std::forward<S>(stream) | map(increment));
+    }
+}
+
+template<size_t Depth>
+void Chain_Stream(benchmark::State & state) {
+    const std::vector<int64_t> & vec = elements<int64_t>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map_chain<Depth>(Stream(view(vec))) | sum());
+    }
+}
+
+template<size_t Depth>
+void Chain_Loop(benchmark::State & state) {
+    const std::vector<int64_t> & vec = elements<int64_t>(state.range(0));
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (int64_t value : vec) {
+            for (size_t i = 0; i < Depth; ++i) {
+                value = increment(value);
+            }
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+#define CPPSTREAM_CHAIN_BENCHMARK(name) \
+    BENCHMARK_TEMPLATE(name, 1)->Arg(1 << 16); \
+    BENCHMARK_TEMPLATE(name, 2)->Arg(1 << 16); \
+    BENCHMARK_TEMPLATE(name, 4)->Arg(1 << 16); \
+    BENCHMARK_TEMPLATE(name, 7)->Arg(1 << 16); \
+    BENCHMARK_TEMPLATE(name, 10)->Arg(1 << 16)
+
+CPPSTREAM_CHAIN_BENCHMARK(Chain_Stream);
+CPPSTREAM_CHAIN_BENCHMARK(Chain_Loop);
+
+#ifdef CPPSTREAM_BENCH_RANGES
+
+template<size_t Depth, class R>
+auto transform_chain(R && range) {
+    if constexpr (Depth == 0) {
+        return std::forward<R>(range);
+    } else {
+        return transform_chain<Depth - 1>(std::forward<R>(range) | std::views::transform(increment));
+    }
+}
+
+template<size_t Depth>
+void Chain_Ranges(benchmark::State & state) {
+    const std::vector<int64_t> & vec = elements<int64_t>(state.range(0));
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (int64_t value : transform_chain<Depth>(std::views::all(vec))) {
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+CPPSTREAM_CHAIN_BENCHMARK(Chain_Ranges);
+
+#endif
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,227 @@
+#ifndef ASYNC_BUFFER_H
+#define ASYNC_BUFFER_H
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "stream_utils.h"
+#include "wait_strategy.h"
+
+namespace cppstream::internal {
+
+/**
+ * Bounded lock-free queue of one producer thread and one consumer thread.
+ * Indices of both sides live on their own cache lines, and each side keeps a cached copy
+ * of the index of the other one, so that it reads the shared one only when the cache says the ring is full or empty.
+ */
+template<class T>
+class SpscRing {
+public:
+    /**
+     * @param capacity least amount of elements the ring holds, rounded up to a power of two
+     */
+    explicit SpscRing(size_t capacity)
+            : mask_(round_up_to_power_of_two(capacity) - 1), slots_(new std::optional<T>[mask_ + 1]) {}
+
+    SpscRing(const SpscRing & other) = delete;
+
+    SpscRing & operator=(const SpscRing & other) = delete;
+
+    /**
+     * Called by the producer only
+     * @return false if the ring is full
+     */
+    template<class U>
+    bool try_push(U && value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_].emplace(std::forward<U>(value));
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Called by the consumer only
+     * @return next element or nothing if the ring is empty
+     */
+    std::optional<T> try_pop() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return std::nullopt;
+            }
+        }
+        std::optional<T> & slot = slots_[head & mask_];
+        std::optional<T> value(std::move(slot));
+        slot.reset();
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    bool full() const {
+        return size() > mask_;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    static size_t round_up_to_power_of_two(size_t value) {
+        size_t power = 1;
+        while (power < value) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<std::optional<T>[]> slots_;
+    // Written by the consumer
+    alignas(cache_line_size) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+    // Written by the producer
+    alignas(cache_line_size) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+};
+
+/**
+ * Runs parent generator on a dedicated producer thread, which starts with the first element taken,
+ * and hands its elements over through an SpscRing of the given capacity.
+ * End of the parent and its exceptions reach the consumer after all elements produced before them.
+ * Destructor stops the producer once its current element is produced and joins it.
+ */
+template<class ParentGenerator>
+class AsyncBufferGenerator {
+public:
+    using value_type = typename ParentGenerator::value_type;
+
+    AsyncBufferGenerator(ParentGenerator && parent_gen, size_t capacity)
+            : state_(std::make_unique<SharedState>(std::move(parent_gen), capacity)) {}
+
+    /**
+     * Copies take the parent of a generator whose producer has not started yet. Once it has, the parent
+     * belongs to the producer thread and cannot be copied.
+     * @throws std::logic_error if the producer of other has started
+     */
+    AsyncBufferGenerator(const AsyncBufferGenerator & other) : state_(copy_state(other)) {}
+
+    AsyncBufferGenerator(AsyncBufferGenerator && other) = default;
+
+    ~AsyncBufferGenerator() {
+        if (state_ && producer_.joinable()) {
+            state_->stopping.store(true, std::memory_order_relaxed);
+            state_->producer_waiter.notify();
+            producer_.join();
+        }
+    }
+
+    AsyncBufferGenerator & operator=(const AsyncBufferGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        start();
+        SharedState & state = *state_;
+        std::optional<value_type> opt = state.ring.try_pop();
+        if (!opt.has_value()) {
+            state.consumer_waiter.wait_until([&state]() {
+                return !state.ring.empty() || state.finished.load(std::memory_order_acquire);
+            });
+            opt = state.ring.try_pop();
+            if (!opt.has_value()) {
+                // The producer has finished, and everything it produced was taken
+                if (state.error) {
+                    std::rethrow_exception(std::exchange(state.error, nullptr));
+                }
+                return std::nullopt;
+            }
+        }
+        if (state.ring.size() <= state.ring.capacity() / 2) {
+            // Waking the producer only once half of the ring is free lets it refill the ring in one go
+            state.producer_waiter.notify();
+        }
+        return opt;
+    }
+
+    /**
+     * Hint of the parent until the producer starts, unknown afterwards
+     */
+    SizeHint size_hint() const {
+        return producer_.joinable() ? SizeHint::unknown() : internal::size_hint_of(state_->parent_gen);
+    }
+
+private:
+    struct SharedState {
+        SharedState(ParentGenerator && parent_gen, size_t capacity)
+                : parent_gen(std::move(parent_gen)), ring_capacity(capacity), ring(capacity) {}
+
+        ParentGenerator parent_gen;
+        const size_t ring_capacity;
+        SpscRing<value_type> ring;
+        // Wakes the consumer waiting for elements
+        park_wait consumer_waiter;
+        // Wakes the producer waiting for free slots
+        park_wait producer_waiter;
+        std::atomic<bool> finished{false};
+        std::atomic<bool> stopping{false};
+        std::exception_ptr error;
+    };
+
+    static std::unique_ptr<SharedState> copy_state(const AsyncBufferGenerator & other) {
+        if (other.producer_.joinable()) {
+            throw std::logic_error("Stream cannot be copied once its async_buffer has started producing elements.");
+        }
+        return std::make_unique<SharedState>(ParentGenerator(other.state_->parent_gen), other.state_->ring_capacity);
+    }
+
+    void start() {
+        if (!producer_.joinable()) {
+            producer_ = std::thread(&AsyncBufferGenerator::produce, state_.get());
+        }
+    }
+
+    static void produce(SharedState * state) {
+        try {
+            internal::for_each_until(state->parent_gen, [state](auto && value) {
+                while (!state->ring.try_push(std::forward<decltype(value)>(value))) {
+                    state->producer_waiter.wait_until([state]() {
+                        return !state->ring.full() || state->stopping.load(std::memory_order_relaxed);
+                    });
+                    if (state->stopping.load(std::memory_order_relaxed)) {
+                        return true;
+                    }
+                }
+                state->consumer_waiter.notify();
+                return state->stopping.load(std::memory_order_relaxed);
+            });
+        } catch (...) {
+            state->error = std::current_exception();
+        }
+        state->finished.store(true, std::memory_order_release);
+        state->consumer_waiter.notify();
+    }
+
+    std::unique_ptr<SharedState> state_;
+    std::thread producer_;
+};
+
+}
+
+#endif //ASYNC_BUFFER_H
@@ -0,0 +1,201 @@
+#ifndef BINARY_FILE_H
+#define BINARY_FILE_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include "mapped_file.h"
+#include "stream_utils.h"
+#include "thread_pool.h"
+
+#ifdef CPPSTREAM_MMAP
+
+namespace cppstream::internal {
+
+/**
+ * Header of files written by write_binary. Records follow it, so that they are aligned to its size.
+ */
+struct BinaryHeader {
+    static constexpr char expected_magic[8] = {'C', 'P', 'P', 'S', 'T', 'R', 'M', '1'};
+
+    char magic[8];
+    uint64_t element_size;
+    uint64_t count;
+    char padding[40];
+};
+
+static_assert(sizeof(BinaryHeader) == 64, "Binary header must keep records 64-byte aligned.");
+
+inline void write_all(int fd, const char * data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "Cannot write output of 'write_binary'");
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+/**
+ * Writes records of type T after a BinaryHeader. Records are gathered into one of two page-aligned chunks
+ * while the other one is written on a background thread, so that production overlaps with I/O.
+ */
+template<class T>
+class BinaryFileWriter {
+    static_assert(std::is_trivially_copyable<T>::value, "Operation write_binary requires trivially copyable elements.");
+public:
+    BinaryFileWriter(const std::string & path, size_t chunk_bytes)
+            : capacity_(std::max<size_t>(chunk_bytes / sizeof(T), 1)) {
+        size_t buffer_bytes = (capacity_ * sizeof(T) + page_size - 1) / page_size * page_size;
+        for (std::unique_ptr<char, FreeDeleter> & buffer : buffers_) {
+            buffer.reset(static_cast<char *>(std::aligned_alloc(page_size, buffer_bytes)));
+            if (!buffer) {
+                throw std::bad_alloc();
+            }
+        }
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot open '" + path + "'");
+        }
+        BinaryHeader header = make_header(0);
+        write_all(fd_, reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+
+    BinaryFileWriter(const BinaryFileWriter & other) = delete;
+
+    ~BinaryFileWriter() {
+        if (pending_.valid()) {
+            pending_.wait();
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    BinaryFileWriter & operator=(const BinaryFileWriter & other) = delete;
+
+    void push(const T & value) {
+        std::memcpy(buffers_[current_].get() + filled_ * sizeof(T), &value, sizeof(T));
+        if (++filled_ == capacity_) {
+            submit_chunk();
+        }
+    }
+
+    void push(span<const T> values) {
+        while (!values.empty()) {
+            size_t count = std::min(values.size(), capacity_ - filled_);
+            std::memcpy(buffers_[current_].get() + filled_ * sizeof(T), values.data(), count * sizeof(T));
+            values = values.subspan(count);
+            filled_ += count;
+            if (filled_ == capacity_) {
+                submit_chunk();
+            }
+        }
+    }
+
+    /**
+     * Writes remaining records, stores their amount in the header and closes the file
+     * @return amount of written records
+     */
+    size_t finish() {
+        if (filled_ > 0) {
+            submit_chunk();
+        }
+        wait_pending();
+        BinaryHeader header = make_header(written_);
+        if (::pwrite(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            throw std::system_error(errno, std::generic_category(), "Cannot write output of 'write_binary'");
+        }
+        int fd = std::exchange(fd_, -1);
+        if (::close(fd) != 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot write output of 'write_binary'");
+        }
+        return written_;
+    }
+
+private:
+    struct FreeDeleter {
+        void operator()(char * ptr) const { std::free(ptr); }
+    };
+
+    static constexpr size_t page_size = 4096;
+
+    static BinaryHeader make_header(uint64_t count) {
+        BinaryHeader header{};
+        std::memcpy(header.magic, BinaryHeader::expected_magic, sizeof(header.magic));
+        header.element_size = sizeof(T);
+        header.count = count;
+        return header;
+    }
+
+    void wait_pending() {
+        if (pending_.valid()) {
+            pending_.get();
+        }
+    }
+
+    void submit_chunk() {
+        wait_pending();
+        const char * data = buffers_[current_].get();
+        size_t bytes = filled_ * sizeof(T);
+        int fd = fd_;
+        pending_ = pool_.submit([fd, data, bytes]() { write_all(fd, data, bytes); });
+        written_ += filled_;
+        current_ ^= 1;
+        filled_ = 0;
+    }
+
+    const size_t capacity_;
+    std::unique_ptr<char, FreeDeleter> buffers_[2];
+    size_t current_ = 0;
+    size_t filled_ = 0;
+    size_t written_ = 0;
+    int fd_ = -1;
+    std::future<void> pending_;
+    // Declared last, so that the writing thread is joined before the buffers are released
+    WorkStealingPool pool_{1};
+};
+
+/**
+ * Maps file written by write_binary, checking that it holds records of type T
+ */
+template<class T>
+mapped_file<T> open_binary_file(const std::string & path) {
+    auto mapping = std::make_shared<const FileMapping>(path);
+    BinaryHeader header{};
+    if (mapping->size() < sizeof(header)) {
+        throw std::runtime_error("'" + path + "' is not a file written by 'write_binary'.");
+    }
+    std::memcpy(&header, mapping->data(), sizeof(header));
+    if (std::memcmp(header.magic, BinaryHeader::expected_magic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("'" + path + "' is not a file written by 'write_binary'.");
+    }
+    if (header.element_size != sizeof(T)) {
+        throw std::runtime_error("Records of '" + path + "' have size different from the requested type.");
+    }
+    // Count comes from the file, so it is checked before multiplying, which could overflow
+    size_t records_size = mapping->size() - sizeof(header);
+    if (header.count > records_size / sizeof(T) || records_size != header.count * sizeof(T)) {
+        throw std::runtime_error("'" + path + "' is truncated.");
+    }
+    return mapped_file<T>(std::move(mapping), sizeof(header), static_cast<size_t>(header.count));
+}
+
+}
+
+#endif
+
+#endif //BINARY_FILE_H
@@ -0,0 +1,255 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include "stream_utils.h"
+#include "wait_strategy.h"
+
+namespace cppstream {
+
+/**
+ * Bounded queue of elements passed between any amount of producer and consumer threads, lock-free
+ * apart from waiting. Slots carry sequence numbers telling whose turn it is to use them, so that
+ * producers and consumers contend only on their own position counter.
+ * Threads wait for free slots or for elements with the given strategy (spin_wait, park_wait or futex_wait).
+ * Closing the channel lets consumers take elements pushed before, and then tells them that no more will come.
+ */
+template<class T, class WaitStrategy = park_wait>
+class channel {
+public:
+    using value_type = T;
+
+    /**
+     * @param capacity least amount of elements the channel holds, rounded up to a power of two
+     */
+    explicit channel(size_t capacity)
+            : mask_(round_up_to_power_of_two(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    channel(const channel & other) = delete;
+
+    channel & operator=(const channel & other) = delete;
+
+    /**
+     * Pushes value, waiting while the channel is full
+     * @return false if the channel was closed, so that value was not pushed
+     */
+    template<class U = T>
+    bool push(U && value) {
+        WriterGuard guard(*this);
+        if (closed_.load(std::memory_order_seq_cst)) {
+            return false;
+        }
+        while (!push_slot<U>(value)) {
+            not_full_.wait_until([this]() {
+                return approximate_size() <= mask_ || closed_.load(std::memory_order_relaxed);
+            });
+            if (closed_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+        }
+        not_empty_.notify();
+        return true;
+    }
+
+    /**
+     * Pushes value unless the channel is full or closed
+     * @return true if value was pushed
+     */
+    template<class U = T>
+    bool try_push(U && value) {
+        WriterGuard guard(*this);
+        if (closed_.load(std::memory_order_seq_cst) || !push_slot<U>(value)) {
+            return false;
+        }
+        not_empty_.notify();
+        return true;
+    }
+
+    /**
+     * Takes next element, waiting while the channel is empty
+     * @return nothing if the channel is closed and all its elements were taken
+     */
+    std::optional<T> pop() {
+        std::optional<T> value;
+        while (!(value = try_pop()).has_value()) {
+            if (drained()) {
+                return std::nullopt;
+            }
+            not_empty_.wait_until([this]() {
+                return approximate_size() > 0 || drained();
+            });
+        }
+        return value;
+    }
+
+    /**
+     * Takes next element unless the channel is empty
+     */
+    std::optional<T> try_pop() {
+        size_t position = dequeue_position_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell & cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto lag = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+            if (lag == 0) {
+                if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    std::optional<T> value(std::move(cell.value));
+                    cell.value.reset();
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    not_full_.notify();
+                    return value;
+                }
+            } else if (lag < 0) {
+                return std::nullopt;
+            } else {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Makes following pushes fail and lets consumers finish once they took all pushed elements
+     */
+    void close() {
+        closed_.store(true, std::memory_order_seq_cst);
+        not_empty_.notify();
+        not_full_.notify();
+    }
+
+    bool closed() const {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    struct alignas(internal::cache_line_size) Cell {
+        std::atomic<size_t> sequence;
+        std::optional<T> value;
+    };
+
+    /**
+     * Counts producers inside push, so that consumers do not finish while a push started before close is completing.
+     * The last producer leaving a closed channel wakes consumers waiting for it.
+     */
+    class WriterGuard {
+    public:
+        explicit WriterGuard(channel & owner) : owner_(owner) {
+            owner_.writers_.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        WriterGuard(const WriterGuard & other) = delete;
+
+        ~WriterGuard() {
+            if (owner_.writers_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+                owner_.closed_.load(std::memory_order_seq_cst)) {
+                owner_.not_empty_.notify();
+            }
+        }
+
+        WriterGuard & operator=(const WriterGuard & other) = delete;
+
+    private:
+        channel & owner_;
+    };
+
+    static size_t round_up_to_power_of_two(size_t value) {
+        size_t power = 1;
+        while (power < value) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    template<class U>
+    bool push_slot(U & value) {
+        size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell & cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+            if (lag == 0) {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value.emplace(std::forward<U>(value));
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t approximate_size() const {
+        size_t dequeued = dequeue_position_.load(std::memory_order_acquire);
+        size_t enqueued = enqueue_position_.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /**
+     * @return true if the channel is closed and no push can add elements anymore
+     */
+    bool drained() const {
+        return closed_.load(std::memory_order_seq_cst) && writers_.load(std::memory_order_seq_cst) == 0 &&
+               approximate_size() == 0;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(internal::cache_line_size) std::atomic<size_t> enqueue_position_{0};
+    alignas(internal::cache_line_size) std::atomic<size_t> dequeue_position_{0};
+    alignas(internal::cache_line_size) std::atomic<size_t> writers_{0};
+    std::atomic<bool> closed_{false};
+    WaitStrategy not_empty_;
+    WaitStrategy not_full_;
+};
+
+}
+
+namespace cppstream::internal {
+
+/**
+ * Takes elements of a channel, which must outlive the generator, until the channel is closed and drained.
+ * Copies take elements of the same channel, each element reaching one of them.
+ */
+template<class T, class WaitStrategy>
+class ChannelGenerator final {
+public:
+    using value_type = T;
+
+    explicit ChannelGenerator(channel<T, WaitStrategy> & source) : channel_(&source) {}
+
+    std::optional<value_type> operator()() {
+        return channel_->pop();
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        std::optional<value_type> opt;
+        while ((opt = channel_->pop())) {
+            if (sink(std::move(opt.value()))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    channel<T, WaitStrategy> * channel_;
+};
+
+}
+
+#endif //CHANNEL_H
@@ -0,0 +1,353 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "stream_utils.h"
+
+#if __has_include(<unistd.h>)
+#define CPPSTREAM_FSEEKO 1
+#include <sys/types.h>
+#endif
+
+namespace cppstream::internal {
+
+/**
+ * Elements which sorted can spill to temporary files as raw bytes and read back
+ */
+template<class T>
+struct is_spillable
+        : std::bool_constant<std::is_trivially_copyable<T>::value && std::is_default_constructible<T>::value> {
+};
+
+/**
+ * Most runs merged at once. More runs are first merged in groups into longer ones, so that read buffers
+ * stay large enough for reads to be efficient.
+ */
+constexpr size_t max_merge_fan_in = 64;
+
+/**
+ * Temporary file holding sorted runs one after another, removed when the file is destroyed
+ */
+template<class T>
+class SpillFile {
+public:
+    SpillFile() : file_(std::tmpfile()) {
+        if (!file_) {
+            throw std::system_error(errno, std::generic_category(), "Cannot create temporary file of 'sorted'");
+        }
+    }
+
+    /**
+     * Appends count elements to the file
+     */
+    void append(const T * elements, size_t count) {
+        if (std::fseek(file_.get(), 0, SEEK_END) != 0 ||
+            std::fwrite(elements, sizeof(T), count, file_.get()) != count) {
+            throw std::system_error(errno, std::generic_category(), "Cannot write temporary file of 'sorted'");
+        }
+        size_ += count;
+    }
+
+    /**
+     * Reads count elements starting from the element at offset
+     */
+    void read(size_t offset, T * elements, size_t count) {
+        if (std::fflush(file_.get()) != 0 || !seek(offset * sizeof(T)) ||
+            std::fread(elements, sizeof(T), count, file_.get()) != count) {
+            throw std::system_error(errno, std::generic_category(), "Cannot read temporary file of 'sorted'");
+        }
+    }
+
+    /**
+     * @return amount of elements in the file
+     */
+    size_t size() const {
+        return size_;
+    }
+
+private:
+    struct FileCloser {
+        void operator()(std::FILE * file) const { std::fclose(file); }
+    };
+
+#ifdef CPPSTREAM_FSEEKO
+    using file_offset = off_t;
+#else
+    using file_offset = long;
+#endif
+
+    /**
+     * Seeks with fseeko where available, as long offsets of fseek have 32 bits on some platforms
+     * @throws std::system_error if byte_offset does not fit into file offsets of the platform
+     */
+    bool seek(size_t byte_offset) {
+        if (byte_offset > static_cast<std::make_unsigned_t<file_offset>>(std::numeric_limits<file_offset>::max())) {
+            throw std::system_error(EOVERFLOW, std::generic_category(),
+                                    "Temporary file of 'sorted' exceeds file offsets of the platform");
+        }
+#ifdef CPPSTREAM_FSEEKO
+        return ::fseeko(file_.get(), static_cast<file_offset>(byte_offset), SEEK_SET) == 0;
+#else
+        return std::fseek(file_.get(), static_cast<file_offset>(byte_offset), SEEK_SET) == 0;
+#endif
+    }
+
+    std::unique_ptr<std::FILE, FileCloser> file_;
+    size_t size_ = 0;
+};
+
+/**
+ * Sorted run of elements in a SpillFile
+ */
+struct SpilledRun {
+    size_t offset;
+    size_t count;
+};
+
+/**
+ * Reads a spilled run back in chunks
+ */
+template<class T>
+class RunReader {
+public:
+    RunReader(SpillFile<T> & file, SpilledRun run) : file_(&file), next_offset_(run.offset), remaining_(run.count) {}
+
+    /**
+     * @return false if the run is exhausted
+     */
+    bool refill(size_t chunk_size) {
+        size_t count = std::min(chunk_size, remaining_);
+        buffer_.resize(count);
+        file_->read(next_offset_, buffer_.data(), count);
+        next_offset_ += count;
+        remaining_ -= count;
+        position_ = 0;
+        return count > 0;
+    }
+
+    T & head() { return buffer_[position_]; }
+
+    /**
+     * @return false if the run is exhausted
+     */
+    bool next(size_t chunk_size) {
+        return ++position_ < buffer_.size() || refill(chunk_size);
+    }
+
+private:
+    SpillFile<T> * file_;
+    size_t next_offset_;
+    // Elements left in the file after the buffer
+    size_t remaining_;
+    std::vector<T> buffer_;
+    size_t position_ = 0;
+};
+
+/**
+ * Merges sorted runs through a heap of runs, which keeps on top the run with the least head,
+ * or the earliest of runs with equal heads, so that merging consecutive runs is stable
+ */
+template<class T, class Compare>
+class RunMerger {
+public:
+    RunMerger(SpillFile<T> & file, const SpilledRun * first, const SpilledRun * last, const Compare & compare,
+              size_t chunk_size) : compare_(compare), chunk_size_(chunk_size) {
+        readers_.reserve(static_cast<size_t>(last - first));
+        for (; first != last; ++first) {
+            readers_.emplace_back(file, *first);
+            if (readers_.back().refill(chunk_size_)) {
+                heap_.push_back(readers_.size() - 1);
+            }
+        }
+        std::make_heap(heap_.begin(), heap_.end(), heap_order());
+    }
+
+    bool empty() const {
+        return heap_.empty();
+    }
+
+    T pop() {
+        std::pop_heap(heap_.begin(), heap_.end(), heap_order());
+        RunReader<T> & reader = readers_[heap_.back()];
+        T value = std::move(reader.head());
+        if (reader.next(chunk_size_)) {
+            std::push_heap(heap_.begin(), heap_.end(), heap_order());
+        } else {
+            heap_.pop_back();
+        }
+        return value;
+    }
+
+private:
+    auto heap_order() {
+        return [this](size_t lhs, size_t rhs) {
+            T & lhs_head = readers_[lhs].head();
+            T & rhs_head = readers_[rhs].head();
+            if (compare_(rhs_head, lhs_head)) {
+                return true;
+            }
+            return !compare_(lhs_head, rhs_head) && rhs < lhs;
+        };
+    }
+
+    Compare compare_;
+    size_t chunk_size_;
+    std::vector<RunReader<T>> readers_;
+    // Indices of readers which are not exhausted
+    std::vector<size_t> heap_;
+};
+
+/**
+ * Yields elements of finite parent generator sorted stably by Compare. Parent is consumed at the first pull
+ * into runs of up to memory_budget bytes. If everything fits into one run, it is sorted in memory; otherwise runs
+ * are sorted and spilled one after another to a temporary file. Up to max_merge_fan_in runs are merged lazily,
+ * one element at a time; more runs are first merged in groups into a new file, pass after pass.
+ * Only trivially copyable elements can be spilled, others are always sorted in memory.
+ * Copies take the parent of a generator which has not started sorting yet.
+ */
+template<class ParentGenerator, class Compare>
+class SortedGenerator {
+public:
+    using value_type = typename ParentGenerator::value_type;
+
+    SortedGenerator(ParentGenerator && parent_gen, Compare compare, size_t memory_budget)
+            : parent_gen_(std::move(parent_gen)), compare_(std::move(compare)),
+              run_capacity_(std::max<size_t>(memory_budget / sizeof(value_type), 1)) {}
+
+    SortedGenerator(const SortedGenerator & other)
+            : parent_gen_(other.parent_gen_), compare_(other.compare_), run_capacity_(other.run_capacity_) {}
+
+    SortedGenerator(SortedGenerator && other) = default;
+
+    ~SortedGenerator() = default;
+
+    SortedGenerator & operator=(const SortedGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        if (!started_) {
+            sort_input();
+        }
+        if (remaining_ == 0) {
+            return std::nullopt;
+        }
+        --remaining_;
+        if (!merger_) {
+            return std::move(run_[position_++]);
+        }
+        return merger_->pop();
+    }
+
+    /**
+     * Size of the parent, as sorting keeps all elements
+     */
+    SizeHint size_hint() const {
+        return started_ ? SizeHint::exact(remaining_) : internal::size_hint_of(parent_gen_);
+    }
+
+private:
+    void sort_input() {
+        started_ = true;
+        internal::for_each_until(parent_gen_, [this](auto && value) {
+            if constexpr (is_spillable<value_type>::value) {
+                if (run_.size() == run_.capacity()) {
+                    // Growing by hand keeps the capacity within the budget
+                    run_.reserve(std::min(std::max<size_t>(2 * run_.capacity(), 16), run_capacity_));
+                }
+            }
+            run_.push_back(std::forward<decltype(value)>(value));
+            ++remaining_;
+            if constexpr (is_spillable<value_type>::value) {
+                if (run_.size() == run_capacity_) {
+                    spill_run();
+                }
+            }
+            return false;
+        });
+        if (runs_.empty()) {
+            std::stable_sort(run_.begin(), run_.end(), compare_);
+            return;
+        }
+        if constexpr (is_spillable<value_type>::value) {
+            if (!run_.empty()) {
+                spill_run();
+            }
+            std::vector<value_type>().swap(run_);
+            while (runs_.size() > max_merge_fan_in) {
+                merge_pass();
+            }
+            merger_.emplace(*file_, runs_.data(), runs_.data() + runs_.size(), compare_, chunk_size(runs_.size()));
+        }
+    }
+
+    void spill_run() {
+        std::stable_sort(run_.begin(), run_.end(), compare_);
+        if (!file_) {
+            file_ = std::make_unique<SpillFile<value_type>>();
+        }
+        runs_.push_back({file_->size(), run_.size()});
+        file_->append(run_.data(), run_.size());
+        run_.clear();
+    }
+
+    /**
+     * Merges consecutive groups of max_merge_fan_in runs into runs of a new file, which replaces the current one
+     */
+    void merge_pass() {
+        auto merged_file = std::make_unique<SpillFile<value_type>>();
+        std::vector<SpilledRun> merged_runs;
+        // Output buffer takes a share of the budget like the read buffer of each run
+        size_t chunk = chunk_size(max_merge_fan_in);
+        std::vector<value_type> output;
+        output.reserve(chunk);
+        for (size_t first = 0; first < runs_.size(); first += max_merge_fan_in) {
+            size_t last = std::min(first + max_merge_fan_in, runs_.size());
+            RunMerger<value_type, Compare> merger(*file_, runs_.data() + first, runs_.data() + last, compare_, chunk);
+            SpilledRun merged{merged_file->size(), 0};
+            while (!merger.empty()) {
+                output.push_back(merger.pop());
+                if (output.size() == chunk) {
+                    merged_file->append(output.data(), output.size());
+                    output.clear();
+                }
+            }
+            merged_file->append(output.data(), output.size());
+            output.clear();
+            merged.count = merged_file->size() - merged.offset;
+            merged_runs.push_back(merged);
+        }
+        file_ = std::move(merged_file);
+        runs_ = std::move(merged_runs);
+    }
+
+    /**
+     * Size of read buffers when merging given amount of runs, which share the budget with one more buffer
+     */
+    size_t chunk_size(size_t run_count) const {
+        return std::max<size_t>(run_capacity_ / (std::min(run_count, max_merge_fan_in) + 1), 1);
+    }
+
+    ParentGenerator parent_gen_;
+    Compare compare_;
+    const size_t run_capacity_;
+    bool started_ = false;
+    size_t remaining_ = 0;
+    // Run being filled, or all elements if nothing was spilled
+    std::vector<value_type> run_;
+    size_t position_ = 0;
+    std::unique_ptr<SpillFile<value_type>> file_;
+    std::vector<SpilledRun> runs_;
+    std::optional<RunMerger<value_type, Compare>> merger_;
+};
+
+}
+
+#endif //EXTERNAL_SORT_H
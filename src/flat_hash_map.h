@@ -0,0 +1,131 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace cppstream::internal {
+
+/**
+ * Hashes keys with std::hash of their type
+ */
+struct default_hash {
+    template<class K>
+    size_t operator()(const K & key) const {
+        return std::hash<K>()(key);
+    }
+};
+
+/**
+ * Insert-only hash map with open addressing. Entries are stored contiguously in order of insertion,
+ * and the table holds only their indices with precomputed hashes, so that probing reads one array of
+ * small slots, compares keys only when the hashes match, and growing the table hashes no keys.
+ * Entries are moved whenever their vector reallocates, so references to them are invalidated by inserts.
+ * Slots are probed linearly from the top bits of the hash multiplied by the golden ratio, which spreads
+ * weak hashes such as std::hash of integers over the whole table.
+ */
+template<class Key, class Value, class Hash = default_hash, class KeyEqual = std::equal_to<>>
+class FlatHashMap {
+public:
+    using entry_type = std::pair<Key, Value>;
+
+    explicit FlatHashMap(Hash hash = Hash(), KeyEqual key_equal = KeyEqual())
+            : hash_(std::move(hash)), key_equal_(std::move(key_equal)) {}
+
+    /**
+     * Inserts key with value make_value() unless the key is present
+     * @return value of key, and true if it was inserted
+     */
+    template<class K, class MakeValue>
+    std::pair<Value &, bool> try_emplace(K && key, MakeValue && make_value) {
+        if (entries_.size() >= max_load()) {
+            grow();
+        }
+        size_t hash = mix(hash_(key));
+        for (size_t position = hash >> shift_;; position = (position + 1) & (slots_.size() - 1)) {
+            Slot & slot = slots_[position];
+            if (slot.index == empty) {
+                slot = {hash, entries_.size()};
+                entries_.emplace_back(std::forward<K>(key), make_value());
+                return {entries_.back().second, true};
+            }
+            if (slot.hash == hash && key_equal_(entries_[slot.index].first, key)) {
+                return {entries_[slot.index].second, false};
+            }
+        }
+    }
+
+    /**
+     * @return value of key, inserted as make_value() if the key is new
+     */
+    template<class K, class MakeValue>
+    Value & find_or_insert(K && key, MakeValue && make_value) {
+        return try_emplace(std::forward<K>(key), std::forward<MakeValue>(make_value)).first;
+    }
+
+    size_t size() const {
+        return entries_.size();
+    }
+
+    /**
+     * Entries in order of insertion
+     */
+    std::vector<entry_type> & entries() {
+        return entries_;
+    }
+
+private:
+    struct Slot {
+        size_t hash;
+        size_t index;
+    };
+
+    static constexpr size_t empty = std::numeric_limits<size_t>::max();
+    static constexpr size_t initial_slots = 16;
+
+    static size_t mix(size_t hash) {
+        return static_cast<size_t>(static_cast<uint64_t>(hash) * UINT64_C(0x9E3779B97F4A7C15));
+    }
+
+    /**
+     * Entries kept below 3/4 of the slots, as linear probing slows down quickly past it
+     */
+    size_t max_load() const {
+        return slots_.size() / 4 * 3;
+    }
+
+    void grow() {
+        size_t slot_count = slots_.empty() ? initial_slots : slots_.size() * 2;
+        std::vector<Slot> old_slots(slot_count, Slot{0, empty});
+        old_slots.swap(slots_);
+        shift_ = std::numeric_limits<size_t>::digits;
+        for (size_t count = slot_count; count > 1; count >>= 1) {
+            --shift_;
+        }
+        for (const Slot & slot : old_slots) {
+            if (slot.index == empty) {
+                continue;
+            }
+            size_t position = slot.hash >> shift_;
+            while (slots_[position].index != empty) {
+                position = (position + 1) & (slot_count - 1);
+            }
+            slots_[position] = slot;
+        }
+    }
+
+    Hash hash_;
+    KeyEqual key_equal_;
+    std::vector<Slot> slots_;
+    // Slot positions are the top bits of mixed hashes
+    size_t shift_ = std::numeric_limits<size_t>::digits;
+    std::vector<entry_type> entries_;
+};
+
+}
+
+#endif //FLAT_HASH_MAP_H
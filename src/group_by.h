@@ -0,0 +1,214 @@
+#ifndef GROUP_BY_H
+#define GROUP_BY_H
+
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "flat_hash_map.h"
+#include "stream_utils.h"
+
+namespace cppstream {
+
+/**
+ * Aggregators of group_by fold elements of each key into a result: initial<T>() gives the result of no elements,
+ * add(result, element) folds an element into it, and combine(result, other) merges into it the result
+ * of elements which came after, so that consecutive parts of a stream can be aggregated independently.
+ */
+
+/**
+ * Amount of elements
+ */
+struct counting {
+    template<class T>
+    using result_type = size_t;
+
+    template<class T>
+    size_t initial() const { return 0; }
+
+    template<class T>
+    void add(size_t & count, T && unused) const { ++count; }
+
+    void combine(size_t & count, size_t && other) const { count += other; }
+};
+
+/**
+ * Sum of elements, or of values which value_function takes from them if given
+ */
+template<class ValueFunction = void>
+struct summing {
+    ValueFunction value_function;
+
+    explicit summing(ValueFunction value_function) : value_function(std::move(value_function)) {}
+
+    template<class T>
+    using result_type = std::decay_t<std::invoke_result_t<const ValueFunction &, const T &>>;
+
+    template<class T>
+    result_type<T> initial() const { return result_type<T>(); }
+
+    template<class R, class T>
+    void add(R & sum, T && element) const { sum += value_function(element); }
+
+    template<class R>
+    void combine(R & sum, R && other) const { sum += other; }
+};
+
+template<>
+struct summing<void> {
+    template<class T>
+    using result_type = T;
+
+    template<class T>
+    T initial() const { return T(); }
+
+    template<class R, class T>
+    void add(R & sum, T && element) const { sum += element; }
+
+    template<class R>
+    void combine(R & sum, R && other) const { sum += other; }
+};
+
+summing() -> summing<void>;
+
+/**
+ * Vector of elements in order of the stream
+ */
+struct collecting {
+    template<class T>
+    using result_type = std::vector<T>;
+
+    template<class T>
+    std::vector<T> initial() const { return std::vector<T>(); }
+
+    template<class R, class T>
+    void add(R & elements, T && element) const { elements.push_back(std::forward<T>(element)); }
+
+    template<class R>
+    void combine(R & elements, R && other) const {
+        elements.insert(elements.end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+    }
+};
+
+/**
+ * Elements folded by operation starting from identity. Combining parts applies operation to their results,
+ * so that it must also accept two results.
+ * @example reducing(std::string(), [](std::string names, const User & user) { return names + user.name; })
+ */
+template<class U, class Operation>
+struct reducing {
+    U identity;
+    Operation operation;
+
+    reducing(U identity, Operation operation) : identity(std::move(identity)), operation(std::move(operation)) {}
+
+    template<class T>
+    using result_type = U;
+
+    template<class T>
+    U initial() const { return identity; }
+
+    template<class T>
+    void add(U & result, T && element) const { result = operation(std::move(result), std::forward<T>(element)); }
+
+    void combine(U & result, U && other) const { result = operation(std::move(result), std::move(other)); }
+};
+
+}
+
+namespace cppstream::internal {
+
+/**
+ * Types of group_by of elements of type T
+ */
+template<class T, class KeyFunction, class Aggregator, class Hash>
+struct group_by_types {
+    using key_type = std::decay_t<std::invoke_result_t<KeyFunction &, const T &>>;
+    using result_type = typename Aggregator::template result_type<T>;
+    using map_type = FlatHashMap<key_type, result_type, Hash>;
+    using entry_type = typename map_type::entry_type;
+};
+
+/**
+ * Aggregates all elements of generator into map by their keys
+ */
+template<class Generator, class KeyFunction, class Aggregator, class Map>
+void aggregate_into(Map & map, Generator & gen, KeyFunction & key_function, const Aggregator & aggregator) {
+    using T = typename Generator::value_type;
+    auto make_initial = [&aggregator]() { return aggregator.template initial<T>(); };
+    internal::for_each_until(gen, [&](auto && value) {
+        aggregator.add(map.find_or_insert(key_function(value), make_initial), std::forward<decltype(value)>(value));
+        return false;
+    });
+}
+
+/**
+ * Merges results of a later part of the stream into map
+ */
+template<class Map, class Aggregator>
+void combine_into(Map & map, Map && other, const Aggregator & aggregator) {
+    for (auto & entry : other.entries()) {
+        auto inserted = map.try_emplace(std::move(entry.first), [&entry]() { return std::move(entry.second); });
+        if (!inserted.second) {
+            aggregator.combine(inserted.first, std::move(entry.second));
+        }
+    }
+}
+
+/**
+ * Yields pairs of keys and their aggregated results, in order of the first elements of keys.
+ * Parent is consumed at the first pull. Copies take the parent of a generator which has not started yet.
+ */
+template<class ParentGenerator, class KeyFunction, class Aggregator, class Hash>
+class AggregateByGenerator {
+    using types = group_by_types<typename ParentGenerator::value_type, KeyFunction, Aggregator, Hash>;
+public:
+    using value_type = typename types::entry_type;
+
+    AggregateByGenerator(ParentGenerator && parent_gen, KeyFunction key_function, Aggregator aggregator, Hash hash)
+            : parent_gen_(std::move(parent_gen)), key_function_(std::move(key_function)),
+              aggregator_(std::move(aggregator)), map_(std::move(hash)) {}
+
+    AggregateByGenerator(const AggregateByGenerator & other) = default;
+
+    AggregateByGenerator(AggregateByGenerator && other) = default;
+
+    ~AggregateByGenerator() = default;
+
+    AggregateByGenerator & operator=(const AggregateByGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        if (!started_) {
+            started_ = true;
+            aggregate_into(map_, parent_gen_, key_function_, aggregator_);
+        }
+        if (position_ == map_.size()) {
+            return std::nullopt;
+        }
+        return std::move(map_.entries()[position_++]);
+    }
+
+    /**
+     * At most as many keys as elements of the parent until aggregated, exact afterwards
+     */
+    SizeHint size_hint() const {
+        if (started_) {
+            return SizeHint::exact(map_.size() - position_);
+        }
+        SizeHint parent_hint = internal::size_hint_of(parent_gen_);
+        return parent_hint.is_known() ? SizeHint::upper_bound(parent_hint.value) : parent_hint;
+    }
+
+private:
+    ParentGenerator parent_gen_;
+    KeyFunction key_function_;
+    Aggregator aggregator_;
+    typename types::map_type map_;
+    bool started_ = false;
+    size_t position_ = 0;
+};
+
+}
+
+#endif //GROUP_BY_H
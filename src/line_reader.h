@@ -0,0 +1,203 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "stream_utils.h"
+
+#if __has_include(<unistd.h>)
+#define CPPSTREAM_FD_INPUT 1
+#include <unistd.h>
+#endif
+
+namespace cppstream::internal {
+
+/**
+ * Reads blocks of characters from std::istream
+ */
+class IstreamReader {
+public:
+    explicit IstreamReader(std::istream & input) : input_(&input) {}
+
+    /**
+     * @return amount of characters read, zero at the end of input
+     */
+    size_t read(char * out, size_t max_count) {
+        input_->read(out, static_cast<std::streamsize>(max_count));
+        return static_cast<size_t>(input_->gcount());
+    }
+
+private:
+    std::istream * input_;
+};
+
+#ifdef CPPSTREAM_FD_INPUT
+
+/**
+ * Reads blocks of characters from file descriptor. Descriptor is not closed.
+ */
+class FdReader {
+public:
+    explicit FdReader(int fd) : fd_(fd) {}
+
+    /**
+     * @return amount of characters read, zero at the end of input
+     */
+    size_t read(char * out, size_t max_count) {
+        for (;;) {
+            ssize_t count = ::read(fd_, out, max_count);
+            if (count >= 0) {
+                return static_cast<size_t>(count);
+            }
+            if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "Cannot read input of 'lines'");
+            }
+        }
+    }
+
+private:
+    int fd_;
+};
+
+#endif
+
+}
+
+namespace cppstream {
+
+constexpr size_t default_line_block_size = 1 << 16;
+
+/**
+ * Delimited records of an input, read by blocks of given size
+ */
+template<class Reader>
+struct line_source {
+    Reader reader;
+    char delimiter;
+    size_t block_size;
+
+    line_source(Reader reader, char delimiter, size_t block_size)
+            : reader(reader), delimiter(delimiter), block_size(block_size) {}
+};
+
+/**
+ * Creates source of records of the input separated by delimiter. Input is not copied, so it must outlive the stream.
+ * @example Stream s(lines(std::cin))
+ */
+inline line_source<internal::IstreamReader> lines(std::istream & input, char delimiter = '\n',
+                                                  size_t block_size = default_line_block_size) {
+    return {internal::IstreamReader(input), delimiter, block_size};
+}
+
+#ifdef CPPSTREAM_FD_INPUT
+
+/**
+ * Creates source of records read from file descriptor separated by delimiter. Descriptor is not closed.
+ * @example Stream s(lines(fd, ','))
+ */
+inline line_source<internal::FdReader> lines(int fd, char delimiter = '\n',
+                                             size_t block_size = default_line_block_size) {
+    return {internal::FdReader(fd), delimiter, block_size};
+}
+
+#endif
+
+}
+
+namespace cppstream::internal {
+
+/**
+ * Yields records of the input as string views into a buffer, which is refilled by blocks.
+ * A view stays valid only until the next record is taken. Records longer than the buffer grow it.
+ * The last record may lack the delimiter. Copies share the input, so only one of them should be read.
+ */
+template<class Reader>
+class LineGenerator {
+public:
+    using value_type = std::string_view;
+
+    explicit LineGenerator(const line_source<Reader> & source)
+            : reader_(source.reader),
+              delimiter_(source.delimiter),
+              buffer_(std::max<size_t>(source.block_size, 1)) {}
+
+    LineGenerator(const LineGenerator & other) = default;
+
+    ~LineGenerator() = default;
+
+    LineGenerator & operator=(const LineGenerator & other) = default;
+
+    std::optional<value_type> operator()() {
+        value_type line;
+        if (!next_line(line)) {
+            return std::nullopt;
+        }
+        return line;
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        value_type line;
+        while (next_line(line)) {
+            if (sink(line)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    bool next_line(value_type & line) {
+        size_t searched = begin_;
+        for (;;) {
+            const char * found = static_cast<const char *>(
+                    std::memchr(buffer_.data() + searched, delimiter_, end_ - searched));
+            if (found != nullptr) {
+                size_t line_end = static_cast<size_t>(found - buffer_.data());
+                line = value_type(buffer_.data() + begin_, line_end - begin_);
+                begin_ = line_end + 1;
+                return true;
+            }
+            if (input_ended_) {
+                if (begin_ == end_) {
+                    return false;
+                }
+                line = value_type(buffer_.data() + begin_, end_ - begin_);
+                begin_ = end_;
+                return true;
+            }
+            searched = end_ - begin_;
+            refill();
+        }
+    }
+
+    /**
+     * Moves the unfinished record to the front of the buffer and reads the next block after it
+     */
+    void refill() {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        if (end_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+        size_t count = reader_.read(buffer_.data() + end_, buffer_.size() - end_);
+        input_ended_ = count == 0;
+        end_ += count;
+    }
+
+    Reader reader_;
+    char delimiter_;
+    std::vector<char> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    bool input_ended_ = false;
+};
+
+}
+
+#endif //LINE_READER_H
@@ -0,0 +1,178 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cerrno>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include "stream_utils.h"
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#define CPPSTREAM_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef CPPSTREAM_MMAP
+
+namespace cppstream::internal {
+
+/**
+ * Read-only private mapping of a whole file, advised for sequential access.
+ * Pages are read from disk only when they are touched.
+ */
+class FileMapping {
+public:
+    explicit FileMapping(const std::string & path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot open '" + path + "'");
+        }
+        struct stat file_stat{};
+        if (::fstat(fd, &file_stat) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Cannot stat '" + path + "'");
+        }
+        size_ = static_cast<size_t>(file_stat.st_size);
+        if (size_ > 0) {
+            void * data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "Cannot map '" + path + "'");
+            }
+            data_ = data;
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+    }
+
+    FileMapping(const FileMapping & other) = delete;
+
+    ~FileMapping() {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    FileMapping & operator=(const FileMapping & other) = delete;
+
+    const void * data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+private:
+    void * data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}
+
+namespace cppstream {
+
+/**
+ * File of packed records of type T mapped into memory. Copies share the mapping,
+ * which is released together with the last of them.
+ */
+template<class T>
+class mapped_file {
+    static_assert(std::is_trivially_copyable<T>::value, "Records of mapped file must be trivially copyable.");
+public:
+    explicit mapped_file(const std::string & path)
+            : mapping_(std::make_shared<const internal::FileMapping>(path)), size_(mapping_->size() / sizeof(T)) {
+        if (mapping_->size() % sizeof(T) != 0) {
+            throw std::runtime_error("Size of '" + path + "' is not a multiple of the record size.");
+        }
+    }
+
+    /**
+     * Records of the mapping starting at offset bytes from its beginning
+     */
+    mapped_file(std::shared_ptr<const internal::FileMapping> mapping, size_t offset, size_t size)
+            : mapping_(std::move(mapping)), offset_(offset), size_(size) {}
+
+    const T * data() const {
+        return reinterpret_cast<const T *>(static_cast<const char *>(mapping_->data()) + offset_);
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    std::shared_ptr<const internal::FileMapping> mapping_;
+    size_t offset_ = 0;
+    size_t size_;
+};
+
+}
+
+namespace cppstream::internal {
+
+/**
+ * Reads records of mapped file in place. Supports everything a view of a vector does:
+ * skipped records are never touched, and blocks of records are handed out without copying.
+ */
+template<class T>
+class MappedFileGenerator final {
+public:
+    using value_type = T;
+
+    explicit MappedFileGenerator(const mapped_file<T> & file)
+            : file_(file), view_(file.data(), file.data() + file.size()) {}
+
+    MappedFileGenerator(const MappedFileGenerator & other) = default;
+
+    ~MappedFileGenerator() = default;
+
+    MappedFileGenerator & operator=(const MappedFileGenerator & other) = default;
+
+    std::optional<value_type> operator()() {
+        return view_();
+    }
+
+    SizeHint size_hint() const {
+        return view_.size_hint();
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        return view_.for_each_until(std::forward<Sink>(sink));
+    }
+
+    size_t next_batch(span<value_type> out) {
+        return view_.next_batch(out);
+    }
+
+    span<const value_type> next_contiguous(size_t max_count) {
+        return view_.next_contiguous(max_count);
+    }
+
+    size_t advance(size_t amount) {
+        return view_.advance(amount);
+    }
+
+    size_t slice_extent() const {
+        return view_.slice_extent();
+    }
+
+    /**
+     * @return generator reading the slice in place, valid while this generator is alive
+     */
+    ViewGenerator<const T *> slice(size_t first, size_t count) const {
+        return view_.slice(first, count);
+    }
+
+private:
+    mapped_file<T> file_;
+    ViewGenerator<const T *> view_;
+};
+
+}
+
+#endif
+
+#endif //MAPPED_FILE_H
@@ -0,0 +1,204 @@
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#if __has_include(<unistd.h>)
+#define CPPSTREAM_FD_OUTPUT 1
+#include <unistd.h>
+#endif
+
+namespace cppstream::internal {
+
+/**
+ * Output of write_to: a file descriptor, a C stream or an std::ostream
+ */
+class OutputTarget {
+public:
+#ifdef CPPSTREAM_FD_OUTPUT
+
+    explicit OutputTarget(int fd) : kind_(Kind::Fd), fd_(fd) {}
+
+#endif
+
+    explicit OutputTarget(std::FILE * file) : kind_(Kind::File), file_(file) {}
+
+    explicit OutputTarget(std::ostream & ostream) : kind_(Kind::Ostream), ostream_(&ostream) {}
+
+    void write(const char * data, size_t size) {
+        switch (kind_) {
+#ifdef CPPSTREAM_FD_OUTPUT
+            case Kind::Fd:
+                while (size > 0) {
+                    ssize_t written = ::write(fd_, data, size);
+                    if (written < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        throw std::system_error(errno, std::generic_category(), "Cannot write output of 'write_to'");
+                    }
+                    data += written;
+                    size -= static_cast<size_t>(written);
+                }
+                break;
+#endif
+            case Kind::File:
+                if (std::fwrite(data, 1, size, file_) != size) {
+                    throw std::system_error(errno, std::generic_category(), "Cannot write output of 'write_to'");
+                }
+                break;
+            case Kind::Ostream:
+                if (!ostream_->write(data, static_cast<std::streamsize>(size))) {
+                    throw std::runtime_error("Cannot write output of 'write_to'");
+                }
+                break;
+        }
+    }
+
+private:
+    enum class Kind {
+        Fd, File, Ostream
+    };
+
+    Kind kind_;
+    union {
+        int fd_;
+        std::FILE * file_;
+        std::ostream * ostream_;
+    };
+};
+
+template<class T>
+struct is_text_writable
+        : std::bool_constant<std::is_arithmetic<T>::value || std::is_convertible<const T &, std::string_view>::value> {
+};
+
+/**
+ * Formats values into a large staging buffer and hands it to the target in big writes.
+ * Arithmetic values are formatted by std::to_chars, independent of any locale; floating-point values
+ * get the shortest representation which reads back to the same value.
+ * Without floating-point std::to_chars (__cpp_lib_to_chars undefined), integers are formatted by hand and
+ * floating-point values by snprintf with max_digits10 significant digits, which reads back to the same value
+ * but is not the shortest form, so the text may differ from the one of std::to_chars.
+ */
+class BufferedWriter {
+public:
+    explicit BufferedWriter(OutputTarget target, size_t capacity = 1 << 20)
+            : target_(target), capacity_(std::max<size_t>(capacity, max_value_chars)),
+              buffer_(new char[capacity_]) {}
+
+    BufferedWriter(const BufferedWriter & other) = delete;
+
+    BufferedWriter & operator=(const BufferedWriter & other) = delete;
+
+    void append(std::string_view text) {
+        if (text.size() > capacity_ - size_) {
+            flush();
+        }
+        if (text.size() > capacity_) {
+            // Text larger than the buffer is written directly
+            target_.write(text.data(), text.size());
+            return;
+        }
+        std::memcpy(buffer_.get() + size_, text.data(), text.size());
+        size_ += text.size();
+    }
+
+    template<class T>
+    void append_value(const T & value) {
+        static_assert(is_text_writable<T>::value,
+                      "Operation write_to can only be performed on streams of arithmetic or string-like elements.");
+        if constexpr (std::is_convertible<const T &, std::string_view>::value) {
+            append(std::string_view(value));
+        } else if constexpr (std::is_same<T, char>::value || std::is_same<T, signed char>::value ||
+                             std::is_same<T, unsigned char>::value) {
+            if (size_ == capacity_) {
+                flush();
+            }
+            buffer_[size_++] = static_cast<char>(value);
+        } else if constexpr (std::is_same<T, bool>::value) {
+            append(value ? "1" : "0");
+        } else {
+            if (capacity_ - size_ < max_value_chars) {
+                flush();
+            }
+            char * first = buffer_.get() + size_;
+            char * last = first + max_value_chars;
+#if defined(__cpp_lib_to_chars)
+            size_ += static_cast<size_t>(std::to_chars(first, last, value).ptr - first);
+#else
+            if constexpr (std::is_floating_point<T>::value) {
+                size_ += static_cast<size_t>(std::snprintf(first, max_value_chars, "%.*Lg",
+                                                           std::numeric_limits<T>::max_digits10,
+                                                           static_cast<long double>(value)));
+            } else {
+                size_ += static_cast<size_t>(format_integer(first, last, value) - first);
+            }
+#endif
+        }
+    }
+
+    void flush() {
+        if (size_ > 0) {
+            target_.write(buffer_.get(), size_);
+            size_ = 0;
+        }
+    }
+
+private:
+    // Longest text of an arithmetic value, reached by long double
+    static constexpr size_t max_value_chars = 64;
+
+#if !defined(__cpp_lib_to_chars)
+
+    /**
+     * Writes decimal text of value, with digits formed from the end of [first, last)
+     * @return end of the text
+     */
+    template<class T>
+    static char * format_integer(char * first, char * last, T value) {
+        using magnitude_type = std::make_unsigned_t<T>;
+        bool negative = false;
+        auto magnitude = static_cast<magnitude_type>(value);
+        if constexpr (std::is_signed<T>::value) {
+            negative = value < 0;
+            if (negative) {
+                // Negated in unsigned arithmetic, as the least value has no positive counterpart in T
+                magnitude = magnitude_type(0) - magnitude;
+            }
+        }
+        char * digits = last;
+        do {
+            *--digits = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (negative) {
+            *--digits = '-';
+        }
+        auto length = static_cast<size_t>(last - digits);
+        std::memmove(first, digits, length);
+        return first + length;
+    }
+
+#endif
+
+    OutputTarget target_;
+    size_t capacity_;
+    std::unique_ptr<char[]> buffer_;
+    size_t size_ = 0;
+};
+
+}
+
+#endif //OUTPUT_WRITER_H
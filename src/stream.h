@@ -1,11 +1,70 @@
 #ifndef STREAM_H
 #define STREAM_H
 
+#include <cstddef>
 #include <functional>
+#include <memory_resource>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "async_buffer.h"
+#include "binary_file.h"
+#include "channel.h"
+#include "external_sort.h"
+#include "group_by.h"
+#include "line_reader.h"
+#include "mapped_file.h"
+#include "output_writer.h"
+#include "stream_profile.h"
+#include "stream_simd.h"
 #include "stream_utils.h"
+#include "thread_pool.h"
+#include "window.h"
 
 namespace cppstream {
 
+/**
+ * Non-owning range of elements. Stream constructed from range_view reads elements directly from
+ * the range without copying it, so the range must outlive the stream.
+ */
+template<class Iterator>
+struct range_view {
+    Iterator first;
+    Iterator last;
+
+    range_view(Iterator first, Iterator last) : first(first), last(last) {}
+};
+
+/**
+ * Creates range_view of [first, last)
+ * @example Stream s(view(myVector.begin(), myVector.end()))
+ */
+template<class Iterator,
+        typename = std::enable_if_t<internal::is_iterator<Iterator>::value>>
+range_view<Iterator> view(Iterator first, Iterator last) {
+    return range_view<Iterator>(first, last);
+}
+
+/**
+ * Creates range_view of all elements of the container.
+ * Elements of contiguous containers are viewed through plain pointers.
+ * @example Stream s(view(myVector))
+ */
+template<class Container,
+        typename = std::enable_if_t<internal::is_container<Container>::value>>
+range_view<internal::view_iterator_t<Container>> view(const Container & container) {
+    if constexpr (internal::is_contiguous_container<Container>::value) {
+        return {container.data(), container.data() + container.size()};
+    } else {
+        return {container.begin(), container.end()};
+    }
+}
+
+template<class Container,
+        typename = std::enable_if_t<internal::is_container<Container>::value>>
+void view(const Container && container) = delete;
+
 struct print_to {
     std::ostream & ostream;
     const char * delimiter;
@@ -14,32 +73,253 @@ struct print_to {
             : ostream(os), delimiter(delimiter) {}
 };
 
+/**
+ * Writes arithmetic or string-like elements separated by delimiter to a file descriptor, a C stream
+ * or an std::ostream. Elements are formatted by std::to_chars into a large buffer, which is written in big chunks.
+ * @example s | write_to(STDOUT_FILENO, "\n")
+ */
+struct write_to {
+    internal::OutputTarget target;
+    const char * delimiter;
+
+#ifdef CPPSTREAM_FD_OUTPUT
+
+    explicit write_to(int fd, const char * delimiter = " ")
+            : target(fd), delimiter(delimiter) {}
+
+#endif
+
+    explicit write_to(std::FILE * file, const char * delimiter = " ")
+            : target(file), delimiter(delimiter) {}
+
+    explicit write_to(std::ostream & os, const char * delimiter = " ")
+            : target(os), delimiter(delimiter) {}
+};
+
+#ifdef CPPSTREAM_MMAP
+
+/**
+ * Writes trivially copyable elements to a binary file, which can be read back by from_binary
+ * @example s | write_binary("checkpoint.bin")
+ */
+struct write_binary {
+    std::string path;
+    size_t chunk_bytes;
+
+    explicit write_binary(std::string path, size_t chunk_bytes = 1 << 20)
+            : path(std::move(path)), chunk_bytes(chunk_bytes) {}
+};
+
+#endif
+
 struct nth {
     size_t n;
 
     explicit nth(size_t n) : n(n) {}
 };
 
-template<class U, class T>
+/**
+ * Reduces stream to a single value. Callables are stored as given, so calls to them can be inlined.
+ * Explicitly given U and T, as in reduce<double, int>(...), keep callables in std::function.
+ * @tparam U result type, deduced from the callables if void
+ * @tparam T type of stream elements, may be void if U is deduced
+ */
+template<class U = void, class T = void,
+        class Identity = std::function<U(T)>,
+        class Accumulator = std::function<U(U, T)>,
+        class Combiner = std::function<U(U, U)>>
 struct reduce {
-    typedef std::function<U(T)> Identity;
-    typedef std::function<U(U, T)> Accumulator;
-
     Identity identity;
     Accumulator accumulator;
+    // Merges results of reducing adjacent parts of the stream, must be associative. Optional.
+    Combiner combiner;
+
+    explicit reduce(Accumulator accumulator)
+            : identity(internal::cast_identity<U>()), accumulator(std::move(accumulator)), combiner() {}
 
-    explicit reduce(Accumulator && accumulator)
-            : identity([](T val) { return static_cast<U>(val); }), accumulator(accumulator) {}
+    reduce(Identity identity,
+           Accumulator accumulator)
+            : identity(std::move(identity)), accumulator(std::move(accumulator)), combiner() {}
 
-    reduce(Identity && identity,
-           Accumulator && accumulator)
-            : identity(std::move(identity)), accumulator(std::move(accumulator)) {}
+    reduce(Identity identity,
+           Accumulator accumulator,
+           Combiner combiner)
+            : identity(std::move(identity)), accumulator(std::move(accumulator)), combiner(std::move(combiner)) {}
 };
 
+template<class Accumulator>
+reduce(Accumulator accumulator) ->
+reduce<void, void, internal::cast_identity<void>, Accumulator, internal::no_combiner>;
+
+template<class Identity, class Accumulator>
+reduce(Identity identity, Accumulator accumulator) ->
+reduce<void, void, Identity, Accumulator, internal::no_combiner>;
+
+template<class Identity, class Accumulator, class Combiner>
+reduce(Identity identity, Accumulator accumulator, Combiner combiner) ->
+reduce<void, void, Identity, Accumulator, Combiner>;
+
+/**
+ * Collects elements of the stream into a vector allocated by given allocator or memory resource
+ * @example s | to_vector(&arena)
+ */
+template<class Allocator = void>
 struct to_vector {
+    Allocator allocator;
+
+    explicit to_vector(const Allocator & allocator) : allocator(allocator) {}
+};
+
+template<>
+struct to_vector<void> {
+};
+
+to_vector() -> to_vector<void>;
+
+template<class Resource, typename = std::enable_if_t<std::is_base_of<std::pmr::memory_resource, Resource>::value>>
+to_vector(Resource * memory_resource) -> to_vector<std::pmr::polymorphic_allocator<std::byte>>;
+
+template<class Allocator>
+to_vector(Allocator allocator) -> to_vector<Allocator>;
+
+/**
+ * Order in which floating-point elements may be summed up
+ */
+enum class SummationOrder {
+    // Elements are added one by one from first to last, as a plain loop would do. Results are reproducible.
+    Sequential,
+    // Elements may be added in any order, which lets summation run on vector kernels.
+    // Result may differ from the sequential one in the last bits due to rounding.
+    Any
 };
 
 struct sum {
+    SummationOrder order;
+
+    explicit sum(SummationOrder order = SummationOrder::Sequential) : order(order) {}
+};
+
+struct min {
+};
+
+struct max {
+};
+
+/**
+ * First k elements of the stream in the order of compare, which by default are the k greatest ones
+ * from the greatest. Keeps a heap of k elements, taking O(n log k) time and O(k) memory.
+ * @example s | top_k(10, [](const auto & lhs, const auto & rhs) { return lhs.score > rhs.score; })
+ */
+template<class Compare = std::greater<>>
+struct top_k {
+    size_t k;
+    Compare compare;
+
+    explicit top_k(size_t k, Compare compare = Compare()) : k(k), compare(std::move(compare)) {}
+};
+
+/**
+ * Aggregates elements of each key given by key_function with aggregator (counting, summing, collecting
+ * or reducing; collecting by default), and returns vector of pairs of keys and results in order of the first
+ * elements of keys. Keys are hashed by hash into an open-addressing table, which allocates nothing per key.
+ * Runs on parallel streams by aggregating consecutive parts independently and combining their results.
+ * @example auto visits = s | group_by([](const Hit & hit) { return hit.user_id; }, counting())
+ */
+template<class KeyFunction, class Aggregator = collecting, class Hash = internal::default_hash>
+struct group_by {
+    KeyFunction key_function;
+    Aggregator aggregator;
+    Hash hash;
+
+    explicit group_by(KeyFunction key_function, Aggregator aggregator = Aggregator(), Hash hash = Hash())
+            : key_function(std::move(key_function)), aggregator(std::move(aggregator)), hash(std::move(hash)) {}
+};
+
+/**
+ * Stage yielding pairs of keys and results of group_by, which aggregates the whole stream
+ * when the first pair is taken
+ */
+template<class KeyFunction, class Aggregator = collecting, class Hash = internal::default_hash>
+struct aggregate_by {
+    KeyFunction key_function;
+    Aggregator aggregator;
+    Hash hash;
+
+    explicit aggregate_by(KeyFunction key_function, Aggregator aggregator = Aggregator(), Hash hash = Hash())
+            : key_function(std::move(key_function)), aggregator(std::move(aggregator)), hash(std::move(hash)) {}
+};
+
+/**
+ * Counts all elements of the stream, or only those satisfying the predicate if one is given
+ */
+template<class Predicate = void>
+struct count {
+    Predicate predicate;
+
+    explicit count(Predicate && predicate) : predicate(std::move(predicate)) {}
+
+    explicit count(const Predicate & predicate) : predicate(predicate) {}
+};
+
+template<>
+struct count<void> {
+};
+
+count() -> count<void>;
+
+template<class Predicate>
+struct any_of {
+    Predicate predicate;
+
+    explicit any_of(Predicate && predicate) : predicate(std::move(predicate)) {}
+
+    explicit any_of(const Predicate & predicate) : predicate(predicate) {}
+};
+
+template<class Predicate>
+struct all_of {
+    Predicate predicate;
+
+    explicit all_of(Predicate && predicate) : predicate(std::move(predicate)) {}
+
+    explicit all_of(const Predicate & predicate) : predicate(predicate) {}
+};
+
+template<class Predicate>
+struct find_first {
+    Predicate predicate;
+
+    explicit find_first(Predicate && predicate) : predicate(std::move(predicate)) {}
+
+    explicit find_first(const Predicate & predicate) : predicate(predicate) {}
+};
+
+template<class Function>
+struct for_each {
+    Function function;
+
+    explicit for_each(Function && function) : function(std::move(function)) {}
+
+    explicit for_each(const Function & function) : function(function) {}
+};
+
+/**
+ * Lets terminal operations of the stream run on given amount of threads
+ */
+struct par {
+    size_t threads;
+
+    explicit par(size_t threads = std::thread::hardware_concurrency()) : threads(threads) {}
+};
+
+/**
+ * Makes stages added after it allocate their internal buffers from given memory resource.
+ * The resource is used only on the thread consuming the stream.
+ */
+struct use_resource {
+    std::pmr::memory_resource * memory_resource;
+
+    explicit use_resource(std::pmr::memory_resource * memory_resource) : memory_resource(memory_resource) {}
 };
 
 struct skip {
@@ -54,7 +334,29 @@ struct get {
     explicit get(size_t amount) : amount(amount) {}
 };
 
+/**
+ * Marks group of runtime size to yield spans over a reused buffer instead of vectors.
+ * Groups of runtime size can also be given an allocator or a memory resource for their vectors.
+ */
+struct reuse_buffer_t {
+    explicit reuse_buffer_t() = default;
+};
+
+inline constexpr reuse_buffer_t reuse_buffer{};
+
+constexpr size_t dynamic_group_size = 0;
+
+/**
+ * Groups of compile-time size are stored inline and never allocate
+ * @example s | group<4>()
+ */
+template<size_t GroupSize = dynamic_group_size, class Storage = void>
 struct group {
+    static_assert(GroupSize > 0, "Groups can only have positive size.");
+};
+
+template<>
+struct group<dynamic_group_size, void> {
     size_t group_size;
 
     explicit group(size_t group_size) : group_size(group_size) {
@@ -62,6 +364,22 @@ struct group {
     }
 };
 
+template<class Storage>
+struct group<dynamic_group_size, Storage> {
+    size_t group_size;
+    Storage storage;
+
+    group(size_t group_size, const Storage & storage) : group_size(group_size), storage(storage) {}
+};
+
+group(size_t) -> group<dynamic_group_size, void>;
+
+template<class Resource, typename = std::enable_if_t<std::is_base_of<std::pmr::memory_resource, Resource>::value>>
+group(size_t, Resource * memory_resource) -> group<dynamic_group_size, std::pmr::polymorphic_allocator<std::byte>>;
+
+template<class Storage>
+group(size_t, Storage storage) -> group<dynamic_group_size, Storage>;
+
 template<class Predicate>
 struct filter {
     Predicate predicate;
@@ -80,6 +398,100 @@ struct map {
     explicit map(const Transform & transform) : transform(transform) {}
 };
 
+/**
+ * Map transforming elements on a thread pool. Keeps up to window elements in flight and yields results
+ * in order of the stream.
+ */
+template<class Transform>
+struct par_map {
+    Transform transform;
+    size_t threads;
+    size_t window;
+
+    explicit par_map(Transform && transform,
+                     size_t threads = std::thread::hardware_concurrency(),
+                     size_t window = 0)
+            : transform(std::move(transform)), threads(std::max<size_t>(threads, 1)),
+              window(window ? window : 2 * this->threads) {}
+
+    explicit par_map(const Transform & transform,
+                     size_t threads = std::thread::hardware_concurrency(),
+                     size_t window = 0)
+            : transform(transform), threads(std::max<size_t>(threads, 1)),
+              window(window ? window : 2 * this->threads) {}
+};
+
+/**
+ * Windows of size consecutive elements starting every step elements, so that they overlap when step is less
+ * than size. Only complete windows are yielded. Without an aggregate, windows are spans into a buffer
+ * reused for every window; with one (moving_sum, moving_mean, moving_min, moving_max, moving_reduce),
+ * they are aggregated incrementally in O(1) per element.
+ * @example s | window(10000, 1, moving_mean())
+ */
+template<class Aggregate = void>
+struct window {
+    size_t size;
+    size_t step;
+    Aggregate aggregate;
+
+    window(size_t size, size_t step, Aggregate aggregate) : size(size), step(step), aggregate(std::move(aggregate)) {}
+};
+
+template<>
+struct window<void> {
+    size_t size;
+    size_t step;
+
+    explicit window(size_t size, size_t step = 1) : size(size), step(step) {}
+};
+
+window(size_t size) -> window<void>;
+
+window(size_t size, size_t step) -> window<void>;
+
+constexpr size_t default_sort_memory_budget = size_t(64) << 20;
+
+/**
+ * Elements of the stream sorted stably by compare. Input is cut into runs of up to memory_budget bytes;
+ * if it does not fit into one run, sorted runs are spilled to temporary files and merged lazily, so that
+ * elements come out while the runs are still being merged. Only trivially copyable elements are spilled,
+ * others are sorted in memory whatever the budget.
+ * @example s | sorted(std::less<>(), 16 << 20) | get(100)
+ */
+template<class Compare = std::less<>>
+struct sorted {
+    Compare compare;
+    size_t memory_budget;
+
+    explicit sorted(Compare compare = Compare(), size_t memory_budget = default_sort_memory_budget)
+            : compare(std::move(compare)), memory_budget(memory_budget) {}
+};
+
+/**
+ * Runs all previous stages on a dedicated producer thread, which hands elements over through a ring
+ * of given capacity, so that producing elements overlaps with the following stages.
+ * Elements must own their data: records of lines and groups reusing a buffer have to be copied before it.
+ * @example Stream(lines(fd)) | map(parse) | async_buffer(4096) | filter(f) | count()
+ */
+struct async_buffer {
+    size_t capacity;
+
+    explicit async_buffer(size_t capacity = 1024) : capacity(std::max<size_t>(capacity, 1)) {}
+};
+
+/**
+ * Probe adding statistics of elements passing its point of the pipeline to the report.
+ * Unless profiling is enabled, the probe is not inserted at all and costs nothing.
+ * @example s | profile("source", report) | filter(f) | profile("filter", report)
+ */
+template<bool Enabled = profiling_enabled>
+struct profile {
+    const char * name;
+    pipeline_profile & report;
+
+    profile(const char * name, pipeline_profile & report) : name(name), report(report) {}
+};
+
 struct IllegalStreamOperation : public std::logic_error {
     explicit IllegalStreamOperation(const char * msg) : logic_error(msg) {}
 };
@@ -132,6 +544,44 @@ public:
                                               std::is_move_constructible<Container>::value, Container> * = nullptr)
             : generator_(internal::ContainerGenerator(std::move(container))) {}
 
+    /**
+    * Constructs Stream reading elements of the viewed range in place, without copying it
+    * @example Stream s(view(myVector))
+    */
+    template<class Iterator>
+    explicit Stream(range_view<Iterator> range)
+            : generator_(internal::ViewGenerator<Iterator>(range.first, range.last)) {}
+
+    /**
+    * Constructs Stream of delimited records of the input. Records are views into a buffer of the stream,
+    * each of them is valid only until the next record is taken.
+    * @example Stream s(lines(std::cin))
+    */
+    template<class Reader>
+    explicit Stream(const line_source<Reader> & source)
+            : generator_(internal::LineGenerator<Reader>(source)) {}
+
+    /**
+    * Constructs Stream taking elements of the channel, which ends once the channel is closed
+    * and all its elements were taken. Channel must outlive the stream.
+    * @example channel<Event> events(1024); Stream s(events)
+    */
+    template<class T, class WaitStrategy>
+    explicit Stream(channel<T, WaitStrategy> & source)
+            : generator_(internal::ChannelGenerator<T, WaitStrategy>(source)) {}
+
+#ifdef CPPSTREAM_MMAP
+
+    /**
+    * Constructs Stream reading records of the mapped file in place
+    * @example Stream s(mapped_file<Record>("records.bin"))
+    */
+    template<class T>
+    explicit Stream(const mapped_file<T> & file)
+            : generator_(internal::MappedFileGenerator<T>(file)) {}
+
+#endif
+
     /**
     * Constructs Stream from the initializer_list
     * @example Stream s({1, 2, 3, 4, 5})
@@ -146,19 +596,19 @@ public:
      */
     template<class T, class... Args>
     Stream(T first, Args... args)
-            : Stream(args...) {
-        generator_.push_back(first);
+            : Stream(std::move(args)...) {
+        generator_.push_back(std::move(first));
     }
 
     template<class T>
     Stream(T first,
            typename std::enable_if_t<!internal::is_value_generator<T>::value &&
                                      !internal::is_container<T>::value, T> * = nullptr) {
-        generator_.push_back(first);
+        generator_.push_back(std::move(first));
     }
 
     Stream(Stream && other) noexcept
-            : generator_(std::move(other.generator_)) {}
+            : generator_(std::move(other.generator_)), options_(other.options_) {}
 
     Stream(const Stream & other) = default;
 
@@ -170,151 +620,858 @@ public:
      */
     constexpr bool is_finite() const { return Tag == StreamTag::Finite; }
 
-    std::ostream & operator|(print_to && operation_props);
+    /**
+     * Tells how many elements the stream has: exactly, at most, or that it is unknown
+     * @example Stream(1, 2, 3) | filter(isOdd) has at most 3 elements
+     */
+    SizeHint size_hint() const { return internal::size_hint_of(generator_); }
+
+    // Operations on lvalue streams work on a copy of the stream, leaving it intact.
+    // Operations on rvalue streams move the generator into the next stage or consume it in place.
+
+    std::ostream & operator|(print_to && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    std::ostream & operator|(print_to && operation_props) &&;
+
+    void operator|(write_to && operation_props) const & {
+        Stream(*this) | std::move(operation_props);
+    }
+
+    void operator|(write_to && operation_props) &&;
+
+#ifdef CPPSTREAM_MMAP
+
+    size_t operator|(write_binary && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    size_t operator|(write_binary && operation_props) &&;
+
+#endif
+
+    value_type operator|(nth && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    value_type operator|(nth && operation_props) &&;
+
+    template<class U, class T, class Identity, class Accumulator, class Combiner>
+    internal::reduce_result_t<U, Identity, Accumulator, value_type>
+    operator|(reduce<U, T, Identity, Accumulator, Combiner> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class U, class T, class Identity, class Accumulator, class Combiner>
+    internal::reduce_result_t<U, Identity, Accumulator, value_type>
+    operator|(reduce<U, T, Identity, Accumulator, Combiner> && operation_props) &&;
+
+    std::vector<value_type> operator|(to_vector<> && unused) const & {
+        return Stream(*this) | std::move(unused);
+    }
+
+    std::vector<value_type> operator|(to_vector<> && unused) &&;
+
+    template<class Allocator>
+    std::vector<value_type, internal::rebind_alloc_t<Allocator, value_type>>
+    operator|(to_vector<Allocator> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Allocator>
+    std::vector<value_type, internal::rebind_alloc_t<Allocator, value_type>>
+    operator|(to_vector<Allocator> && operation_props) &&;
+
+    value_type operator|(sum && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    value_type operator|(sum && operation_props) &&;
+
+    value_type operator|(min && unused) const & {
+        return Stream(*this) | std::move(unused);
+    }
+
+    value_type operator|(min && unused) &&;
+
+    value_type operator|(max && unused) const & {
+        return Stream(*this) | std::move(unused);
+    }
+
+    value_type operator|(max && unused) &&;
+
+    template<class Compare>
+    std::vector<value_type> operator|(top_k<Compare> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Compare>
+    std::vector<value_type> operator|(top_k<Compare> && operation_props) &&;
+
+    template<class KeyFunction, class Aggregator, class Hash>
+    std::vector<typename internal::group_by_types<value_type, KeyFunction, Aggregator, Hash>::entry_type>
+    operator|(group_by<KeyFunction, Aggregator, Hash> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class KeyFunction, class Aggregator, class Hash>
+    std::vector<typename internal::group_by_types<value_type, KeyFunction, Aggregator, Hash>::entry_type>
+    operator|(group_by<KeyFunction, Aggregator, Hash> && operation_props) &&;
+
+    size_t operator|(count<> && unused) const & {
+        return Stream(*this) | std::move(unused);
+    }
+
+    size_t operator|(count<> && unused) &&;
+
+    template<class Predicate>
+    size_t operator|(count<Predicate> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Predicate>
+    size_t operator|(count<Predicate> && operation_props) &&;
+
+    template<class Predicate>
+    bool operator|(any_of<Predicate> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Predicate>
+    bool operator|(any_of<Predicate> && operation_props) &&;
+
+    template<class Predicate>
+    bool operator|(all_of<Predicate> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Predicate>
+    bool operator|(all_of<Predicate> && operation_props) &&;
+
+    template<class Predicate>
+    std::optional<value_type> operator|(find_first<Predicate> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Predicate>
+    std::optional<value_type> operator|(find_first<Predicate> && operation_props) &&;
+
+    template<class Function>
+    void operator|(for_each<Function> && operation_props) const & {
+        Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Function>
+    void operator|(for_each<Function> && operation_props) &&;
+
+    Stream operator|(par && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    Stream operator|(par && operation_props) &&;
+
+    Stream operator|(use_resource && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
 
-    value_type operator|(nth && operation_props);
+    Stream operator|(use_resource && operation_props) &&;
 
-    template<class U>
-    U operator|(reduce<U, value_type> && operation_props);
+    Stream<typename internal::skip_stage<StreamGenerator>::type, Tag> operator|(skip && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
 
-    std::vector<value_type> operator|(to_vector && unused);
+    Stream<typename internal::skip_stage<StreamGenerator>::type, Tag> operator|(skip && operation_props) &&;
 
-    value_type operator|(sum && unused);
+    Stream<typename internal::get_stage<StreamGenerator>::type, StreamTag::Finite>
+    operator|(get && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
 
-    Stream<internal::SkipGenerator<StreamGenerator>, Tag> operator|(skip && operation_props);
+    Stream<typename internal::get_stage<StreamGenerator>::type, StreamTag::Finite>
+    operator|(get && operation_props) &&;
 
-    Stream<internal::GetGenerator<StreamGenerator>, StreamTag::Finite> operator|(get && operation_props);
+    template<class Predicate>
+    Stream<typename internal::filter_stage<StreamGenerator, Predicate>::type, Tag>
+    operator|(filter<Predicate> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
 
     template<class Predicate>
-    Stream<internal::FilterGenerator<StreamGenerator, Predicate>, Tag> operator|(filter<Predicate> && operation_props);
+    Stream<typename internal::filter_stage<StreamGenerator, Predicate>::type, Tag>
+    operator|(filter<Predicate> && operation_props) &&;
+
+    Stream<internal::GroupGenerator<StreamGenerator>, Tag> operator|(group<> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    Stream<internal::GroupGenerator<StreamGenerator>, Tag> operator|(group<> && operation_props) &&;
+
+    Stream<internal::SpanGroupGenerator<StreamGenerator>, Tag>
+    operator|(group<dynamic_group_size, reuse_buffer_t> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    Stream<internal::SpanGroupGenerator<StreamGenerator>, Tag>
+    operator|(group<dynamic_group_size, reuse_buffer_t> && operation_props) &&;
+
+    template<class Allocator>
+    Stream<internal::GroupGenerator<StreamGenerator, internal::rebind_alloc_t<Allocator, value_type>>, Tag>
+    operator|(group<dynamic_group_size, Allocator> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
 
-    Stream<internal::GroupGenerator<StreamGenerator>, Tag> operator|(group && operation_props);
+    template<class Allocator>
+    Stream<internal::GroupGenerator<StreamGenerator, internal::rebind_alloc_t<Allocator, value_type>>, Tag>
+    operator|(group<dynamic_group_size, Allocator> && operation_props) &&;
+
+    template<size_t GroupSize>
+    Stream<internal::FixedGroupGenerator<StreamGenerator, GroupSize>, Tag>
+    operator|(group<GroupSize> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<size_t GroupSize>
+    Stream<internal::FixedGroupGenerator<StreamGenerator, GroupSize>, Tag>
+    operator|(group<GroupSize> && operation_props) &&;
 
     template<class Transform>
-    Stream<internal::MapGenerator<StreamGenerator, Transform>, Tag> operator|(map<Transform> && operation_props);
+    Stream<typename internal::map_stage<StreamGenerator, Transform>::type, Tag>
+    operator|(map<Transform> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Transform>
+    Stream<typename internal::map_stage<StreamGenerator, Transform>::type, Tag>
+    operator|(map<Transform> && operation_props) &&;
+
+    template<class Transform>
+    Stream<internal::ParallelMapGenerator<StreamGenerator, Transform>, Tag>
+    operator|(par_map<Transform> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Transform>
+    Stream<internal::ParallelMapGenerator<StreamGenerator, Transform>, Tag>
+    operator|(par_map<Transform> && operation_props) &&;
+
+    Stream<internal::WindowGenerator<StreamGenerator>, Tag> operator|(window<> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    Stream<internal::WindowGenerator<StreamGenerator>, Tag> operator|(window<> && operation_props) &&;
+
+    template<class Aggregate>
+    Stream<internal::WindowAggregateGenerator<StreamGenerator, Aggregate>, Tag>
+    operator|(window<Aggregate> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Aggregate>
+    Stream<internal::WindowAggregateGenerator<StreamGenerator, Aggregate>, Tag>
+    operator|(window<Aggregate> && operation_props) &&;
+
+    template<class Compare>
+    Stream<internal::SortedGenerator<StreamGenerator, Compare>, Tag>
+    operator|(sorted<Compare> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class Compare>
+    Stream<internal::SortedGenerator<StreamGenerator, Compare>, Tag>
+    operator|(sorted<Compare> && operation_props) &&;
+
+    template<class KeyFunction, class Aggregator, class Hash>
+    Stream<internal::AggregateByGenerator<StreamGenerator, KeyFunction, Aggregator, Hash>, Tag>
+    operator|(aggregate_by<KeyFunction, Aggregator, Hash> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<class KeyFunction, class Aggregator, class Hash>
+    Stream<internal::AggregateByGenerator<StreamGenerator, KeyFunction, Aggregator, Hash>, Tag>
+    operator|(aggregate_by<KeyFunction, Aggregator, Hash> && operation_props) &&;
+
+    Stream<internal::AsyncBufferGenerator<StreamGenerator>, Tag> operator|(async_buffer && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    Stream<internal::AsyncBufferGenerator<StreamGenerator>, Tag> operator|(async_buffer && operation_props) &&;
+
+    template<bool Enabled>
+    std::conditional_t<Enabled, Stream<internal::ProfiledGenerator<StreamGenerator>, Tag>, Stream>
+    operator|(profile<Enabled> && operation_props) const & {
+        return Stream(*this) | std::move(operation_props);
+    }
+
+    template<bool Enabled>
+    std::conditional_t<Enabled, Stream<internal::ProfiledGenerator<StreamGenerator>, Tag>, Stream>
+    operator|(profile<Enabled> && operation_props) &&;
 
     template<class OtherGen, StreamTag OtherTag> friend
     class Stream;
 
 private:
     template<class StreamGen>
-    Stream(StreamGen && generator, StreamTag unused)
-            : generator_(std::move(generator)) {}
+    Stream(StreamGen && generator, StreamTag unused, internal::StreamOptions options)
+            : generator_(std::move(generator)), options_(options) {}
+
+    template<class Generator>
+    static std::optional<value_type> sum_of(Generator & gen, SummationOrder order);
+
+    template<class Result, class Generator, class Reduce>
+    static std::optional<Result> reduce_of(Generator & gen, Reduce & operation_props);
+
+    template<class Allocator = std::allocator<value_type>, class Generator>
+    static std::vector<value_type, Allocator> to_vector_of(Generator & gen, const Allocator & allocator = Allocator());
+
+    /**
+     * Merges results of consecutive parts of the stream in order, skipping parts which had no elements
+     */
+    template<class U, class Combiner>
+    static std::optional<U> combine_partials(std::vector<std::optional<U>> && partials, Combiner && combiner);
 
     StreamGenerator generator_;
+    internal::StreamOptions options_;
 };
 
 template<class StreamGenerator, StreamTag Tag>
 std::ostream &
-Stream<StreamGenerator, Tag>::operator|(print_to && operation_props) {
+Stream<StreamGenerator, Tag>::operator|(print_to && operation_props) && {
     static_assert(Tag == StreamTag::Finite, "Operation print_to cannot be performed on infinite stream.");
-    StreamGenerator gen(generator_);
+    StreamGenerator & gen = generator_;
     std::ostream & os = operation_props.ostream;
     std::optional<value_type> opt;
-    if (opt = gen()) {
+    if ((opt = gen())) {
         os << opt.value();
-        while (opt = gen()) {
-            os << operation_props.delimiter << opt.value();
-        }
+        internal::for_each_until(gen, [&](auto && value) {
+            os << operation_props.delimiter << value;
+            return false;
+        });
     }
     return os;
 }
 
+template<class StreamGenerator, StreamTag Tag>
+void Stream<StreamGenerator, Tag>::operator|(write_to && operation_props) && {
+    static_assert(Tag == StreamTag::Finite, "Operation write_to cannot be performed on infinite stream.");
+    internal::BufferedWriter writer(operation_props.target);
+    std::string_view delimiter(operation_props.delimiter);
+    bool first = true;
+    internal::for_each_until(generator_, [&](const auto & value) {
+        if (!first) {
+            writer.append(delimiter);
+        }
+        first = false;
+        writer.append_value(value);
+        return false;
+    });
+    writer.flush();
+}
+
+#ifdef CPPSTREAM_MMAP
+
+template<class StreamGenerator, StreamTag Tag>
+size_t Stream<StreamGenerator, Tag>::operator|(write_binary && operation_props) && {
+    static_assert(Tag == StreamTag::Finite, "Operation write_binary cannot be performed on infinite stream.");
+    internal::BinaryFileWriter<value_type> writer(operation_props.path, operation_props.chunk_bytes);
+    if constexpr (internal::has_next_contiguous<StreamGenerator>::value) {
+        span<const value_type> block;
+        while (!(block = generator_.next_contiguous(internal::reduce_block_size)).empty()) {
+            writer.push(block);
+        }
+    } else {
+        internal::for_each_until(generator_, [&writer](const value_type & value) {
+            writer.push(value);
+            return false;
+        });
+    }
+    return writer.finish();
+}
+
+#endif
+
 template<class StreamGenerator, StreamTag Tag>
 typename Stream<StreamGenerator, Tag>::value_type
-Stream<StreamGenerator, Tag>::operator|(nth && operation_props) {
-    StreamGenerator gen(generator_);
+Stream<StreamGenerator, Tag>::operator|(nth && operation_props) && {
     std::optional<value_type> opt;
-    size_t i = 0;
-    while (i <= operation_props.n && (opt = gen())) {
-        ++i;
+    if (internal::advance(generator_, operation_props.n) == operation_props.n) {
+        opt = generator_();
     }
-    if (i <= operation_props.n) {
+    if (!opt.has_value()) {
         throw IllegalStreamOperation("Stream doesn't contain enough elements to perform operation 'nth'.");
     }
-    return opt.value();
+    return std::move(opt.value());
 }
 
 template<class StreamGenerator, StreamTag Tag>
-template<class U>
-U
-Stream<StreamGenerator, Tag>::operator|(reduce<U, value_type> && operation_props) {
+template<class U, class T, class Identity, class Accumulator, class Combiner>
+internal::reduce_result_t<U, Identity, Accumulator, typename Stream<StreamGenerator, Tag>::value_type>
+Stream<StreamGenerator, Tag>::operator|(reduce<U, T, Identity, Accumulator, Combiner> && operation_props) && {
     static_assert(Tag == StreamTag::Finite, "Operation reduce cannot be performed on infinite stream.");
-    StreamGenerator gen(generator_);
-    std::optional<value_type> opt = gen();
-    if (!opt.has_value()) {
-        throw IllegalStreamOperation("Operation 'reduce' cannot be performed on empty stream.");
+    using Result = internal::reduce_result_t<U, Identity, Accumulator, value_type>;
+    std::optional<Result> result;
+    if constexpr (internal::is_sliceable<StreamGenerator>::value &&
+                  !std::is_same<Combiner, internal::no_combiner>::value) {
+        if (options_.threads > 1 && internal::has_combiner(operation_props.combiner)) {
+            auto partials = internal::parallel_chunks(
+                    options_.threads, generator_.slice_extent(), [&](size_t first, size_t count) {
+                        auto slice = generator_.slice(first, count);
+                        // Functors may be mutable, so every part invokes its own copies
+                        auto part_props = operation_props;
+                        return reduce_of<Result>(slice, part_props);
+                    });
+            result = combine_partials(std::move(partials), operation_props.combiner);
+        }
     }
-    U result = operation_props.identity(opt.value());
-    while (opt = gen()) {
-        result = operation_props.accumulator(result, opt.value());
+    if (!result.has_value()) {
+        result = reduce_of<Result>(generator_, operation_props);
     }
-    return result;
+    if (!result.has_value()) {
+        throw IllegalStreamOperation("Operation 'reduce' cannot be performed on empty stream.");
+    }
+    return std::move(result.value());
 }
 
 template<class StreamGenerator, StreamTag Tag>
-auto Stream<StreamGenerator, Tag>::operator|(to_vector && unused) -> std::vector<value_type> {
+auto Stream<StreamGenerator, Tag>::operator|(to_vector<> && unused) && -> std::vector<value_type> {
+    return std::move(*this) | to_vector(std::allocator<value_type>());
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Allocator>
+auto Stream<StreamGenerator, Tag>::operator|(to_vector<Allocator> && operation_props) &&
+-> std::vector<value_type, internal::rebind_alloc_t<Allocator, value_type>> {
     static_assert(Tag == StreamTag::Finite, "Operation to_vector cannot be performed on infinite stream.");
-    StreamGenerator gen(generator_);
-    std::optional<value_type> opt;
-    std::vector<value_type> vec;
-    while (opt = gen()) {
-        vec.push_back(opt.value());
+    using result_allocator = internal::rebind_alloc_t<Allocator, value_type>;
+    result_allocator allocator(operation_props.allocator);
+    if constexpr (internal::is_sliceable<StreamGenerator>::value) {
+        if (options_.threads > 1) {
+            // Allocators are not required to be thread-safe, so parts are collected with the default one
+            auto chunks = internal::parallel_chunks(
+                    options_.threads, generator_.slice_extent(), [&](size_t first, size_t count) {
+                        auto slice = generator_.slice(first, count);
+                        return to_vector_of(slice);
+                    });
+            size_t total_size = 0;
+            for (const std::vector<value_type> & chunk : chunks) {
+                total_size += chunk.size();
+            }
+            std::vector<value_type, result_allocator> vec(allocator);
+            vec.reserve(total_size);
+            for (std::vector<value_type> & chunk : chunks) {
+                vec.insert(vec.end(), std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
+            }
+            return vec;
+        }
     }
-    return vec;
+    return to_vector_of(generator_, allocator);
 }
 
 template<class StreamGenerator, StreamTag Tag>
 typename Stream<StreamGenerator, Tag>::value_type
-Stream<StreamGenerator, Tag>::operator|(sum && unused) {
+Stream<StreamGenerator, Tag>::operator|(sum && operation_props) && {
     static_assert(Tag == StreamTag::Finite, "Operation sum cannot be performed on infinite stream.");
-    StreamGenerator gen(generator_);
-    std::optional<value_type> opt = gen();
-    if (!opt.has_value()) {
+    std::optional<value_type> result;
+    if constexpr (internal::is_sliceable<StreamGenerator>::value) {
+        bool reorder_allowed = std::is_integral<value_type>::value || operation_props.order == SummationOrder::Any;
+        if (options_.threads > 1 && reorder_allowed) {
+            auto partials = internal::parallel_chunks(
+                    options_.threads, generator_.slice_extent(), [&](size_t first, size_t count) {
+                        auto slice = generator_.slice(first, count);
+                        return sum_of(slice, operation_props.order);
+                    });
+            result = combine_partials(std::move(partials), [](value_type lhs, const value_type & rhs) {
+                lhs += rhs;
+                return lhs;
+            });
+        } else {
+            result = sum_of(generator_, operation_props.order);
+        }
+    } else {
+        result = sum_of(generator_, operation_props.order);
+    }
+    if (!result.has_value()) {
         throw IllegalStreamOperation("Operation 'sum' cannot be performed on empty stream.");
     }
-    value_type stream_sum = opt.value();
-    while (opt = gen()) {
-        stream_sum += opt.value();
+    return std::move(result.value());
+}
+
+template<class StreamGenerator, StreamTag Tag>
+typename Stream<StreamGenerator, Tag>::value_type
+Stream<StreamGenerator, Tag>::operator|(min && unused) && {
+    static_assert(Tag == StreamTag::Finite, "Operation min cannot be performed on infinite stream.");
+    std::optional<value_type> opt = generator_();
+    if (!opt.has_value()) {
+        throw IllegalStreamOperation("Operation 'min' cannot be performed on empty stream.");
+    }
+    if constexpr (internal::can_reduce_blocks<StreamGenerator>::value) {
+        return internal::reduce_blocks<internal::ReduceOp::Min>(generator_, opt.value());
+    } else {
+        internal::for_each_until(generator_, [&](auto && value) {
+            if (value < opt.value()) {
+                opt = std::forward<decltype(value)>(value);
+            }
+            return false;
+        });
+        return std::move(opt.value());
     }
-    return stream_sum;
 }
 
 template<class StreamGenerator, StreamTag Tag>
-Stream<internal::SkipGenerator<StreamGenerator>, Tag>
-Stream<StreamGenerator, Tag>::operator|(skip && operation_props) {
-    using SkipGen = internal::SkipGenerator<StreamGenerator>;
-    return Stream<SkipGen, Tag>(SkipGen(generator_, operation_props.amount), Tag);
+typename Stream<StreamGenerator, Tag>::value_type
+Stream<StreamGenerator, Tag>::operator|(max && unused) && {
+    static_assert(Tag == StreamTag::Finite, "Operation max cannot be performed on infinite stream.");
+    std::optional<value_type> opt = generator_();
+    if (!opt.has_value()) {
+        throw IllegalStreamOperation("Operation 'max' cannot be performed on empty stream.");
+    }
+    if constexpr (internal::can_reduce_blocks<StreamGenerator>::value) {
+        return internal::reduce_blocks<internal::ReduceOp::Max>(generator_, opt.value());
+    } else {
+        internal::for_each_until(generator_, [&](auto && value) {
+            if (opt.value() < value) {
+                opt = std::forward<decltype(value)>(value);
+            }
+            return false;
+        });
+        return std::move(opt.value());
+    }
 }
 
 template<class StreamGenerator, StreamTag Tag>
-Stream<internal::GetGenerator<StreamGenerator>, StreamTag::Finite>
-Stream<StreamGenerator, Tag>::operator|(get && operation_props) {
-    using GetGen = internal::GetGenerator<StreamGenerator>;
-    return Stream<GetGen, StreamTag::Finite>(GetGen(generator_, operation_props.amount), StreamTag::Finite);
+template<class Compare>
+std::vector<typename Stream<StreamGenerator, Tag>::value_type>
+Stream<StreamGenerator, Tag>::operator|(top_k<Compare> && operation_props) && {
+    static_assert(Tag == StreamTag::Finite, "Operation top_k cannot be performed on infinite stream.");
+    const size_t k = operation_props.k;
+    Compare & compare = operation_props.compare;
+    // Heap of the best elements so far, with the worst of them on top
+    std::vector<value_type> heap;
+    if (k == 0) {
+        return heap;
+    }
+    SizeHint hint = internal::size_hint_of(generator_);
+    if (hint.is_known()) {
+        heap.reserve(std::min(k, hint.value));
+    }
+    internal::for_each_until(generator_, [&](auto && value) {
+        if (heap.size() < k) {
+            heap.push_back(std::forward<decltype(value)>(value));
+            std::push_heap(heap.begin(), heap.end(), compare);
+        } else if (compare(value, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), compare);
+            heap.back() = std::forward<decltype(value)>(value);
+            std::push_heap(heap.begin(), heap.end(), compare);
+        }
+        return false;
+    });
+    std::sort_heap(heap.begin(), heap.end(), compare);
+    return heap;
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class KeyFunction, class Aggregator, class Hash>
+std::vector<typename internal::group_by_types<typename Stream<StreamGenerator, Tag>::value_type,
+        KeyFunction, Aggregator, Hash>::entry_type>
+Stream<StreamGenerator, Tag>::operator|(group_by<KeyFunction, Aggregator, Hash> && operation_props) && {
+    static_assert(Tag == StreamTag::Finite, "Operation group_by cannot be performed on infinite stream.");
+    using map_type = typename internal::group_by_types<value_type, KeyFunction, Aggregator, Hash>::map_type;
+    map_type map(operation_props.hash);
+    if constexpr (internal::is_sliceable<StreamGenerator>::value) {
+        if (options_.threads > 1) {
+            auto partials = internal::parallel_chunks(
+                    options_.threads, generator_.slice_extent(), [&](size_t first, size_t count) {
+                        auto slice = generator_.slice(first, count);
+                        KeyFunction key_function = operation_props.key_function;
+                        map_type partial(operation_props.hash);
+                        internal::aggregate_into(partial, slice, key_function, operation_props.aggregator);
+                        return partial;
+                    });
+            for (map_type & partial : partials) {
+                internal::combine_into(map, std::move(partial), operation_props.aggregator);
+            }
+            return std::move(map.entries());
+        }
+    }
+    internal::aggregate_into(map, generator_, operation_props.key_function, operation_props.aggregator);
+    return std::move(map.entries());
+}
+
+template<class StreamGenerator, StreamTag Tag>
+size_t Stream<StreamGenerator, Tag>::operator|(count<> && unused) && {
+    static_assert(Tag == StreamTag::Finite, "Operation count cannot be performed on infinite stream.");
+    return internal::count_elements(generator_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Predicate>
+size_t Stream<StreamGenerator, Tag>::operator|(count<Predicate> && operation_props) && {
+    static_assert(Tag == StreamTag::Finite, "Operation count cannot be performed on infinite stream.");
+    size_t matched = 0;
+    internal::for_each_until(generator_, [&](auto && value) {
+        matched += operation_props.predicate(value) ? 1 : 0;
+        return false;
+    });
+    return matched;
 }
 
 template<class StreamGenerator, StreamTag Tag>
 template<class Predicate>
-Stream<internal::FilterGenerator<StreamGenerator, Predicate>, Tag>
-Stream<StreamGenerator, Tag>::operator|(filter<Predicate> && operation_props) {
-    using FilterGen = internal::FilterGenerator<StreamGenerator, Predicate>;
-    return Stream<FilterGen, Tag>(FilterGen(generator_, operation_props.predicate), Tag);
+bool Stream<StreamGenerator, Tag>::operator|(any_of<Predicate> && operation_props) && {
+    return internal::for_each_until(generator_, [&](auto && value) {
+        return static_cast<bool>(operation_props.predicate(value));
+    });
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Predicate>
+bool Stream<StreamGenerator, Tag>::operator|(all_of<Predicate> && operation_props) && {
+    return !internal::for_each_until(generator_, [&](auto && value) {
+        return !operation_props.predicate(value);
+    });
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Predicate>
+auto Stream<StreamGenerator, Tag>::operator|(find_first<Predicate> && operation_props) && -> std::optional<value_type> {
+    std::optional<value_type> found;
+    internal::for_each_until(generator_, [&](auto && value) {
+        if (!operation_props.predicate(value)) {
+            return false;
+        }
+        found.emplace(std::forward<decltype(value)>(value));
+        return true;
+    });
+    return found;
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Function>
+void Stream<StreamGenerator, Tag>::operator|(for_each<Function> && operation_props) && {
+    static_assert(Tag == StreamTag::Finite, "Operation for_each cannot be performed on infinite stream.");
+    internal::for_each_until(generator_, [&](auto && value) {
+        operation_props.function(std::forward<decltype(value)>(value));
+        return false;
+    });
+}
+
+template<class StreamGenerator, StreamTag Tag>
+Stream<StreamGenerator, Tag>
+Stream<StreamGenerator, Tag>::operator|(par && operation_props) && {
+    options_.threads = std::max<size_t>(operation_props.threads, 1);
+    return std::move(*this);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+Stream<StreamGenerator, Tag>
+Stream<StreamGenerator, Tag>::operator|(use_resource && operation_props) && {
+    options_.memory_resource = operation_props.memory_resource;
+    return std::move(*this);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+Stream<typename internal::skip_stage<StreamGenerator>::type, Tag>
+Stream<StreamGenerator, Tag>::operator|(skip && operation_props) && {
+    using SkipStage = internal::skip_stage<StreamGenerator>;
+    return Stream<typename SkipStage::type, Tag>(
+            SkipStage::make(std::move(generator_), operation_props.amount), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+Stream<typename internal::get_stage<StreamGenerator>::type, StreamTag::Finite>
+Stream<StreamGenerator, Tag>::operator|(get && operation_props) && {
+    using GetStage = internal::get_stage<StreamGenerator>;
+    return Stream<typename GetStage::type, StreamTag::Finite>(
+            GetStage::make(std::move(generator_), operation_props.amount), StreamTag::Finite, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Predicate>
+Stream<typename internal::filter_stage<StreamGenerator, Predicate>::type, Tag>
+Stream<StreamGenerator, Tag>::operator|(filter<Predicate> && operation_props) && {
+    using FilterStage = internal::filter_stage<StreamGenerator, Predicate>;
+    return Stream<typename FilterStage::type, Tag>(
+            FilterStage::make(std::move(generator_), std::move(operation_props.predicate)), Tag, options_);
 }
 
 template<class StreamGenerator, StreamTag Tag>
 Stream<internal::GroupGenerator<StreamGenerator>, Tag>
-Stream<StreamGenerator, Tag>::operator|(group && operation_props) {
+Stream<StreamGenerator, Tag>::operator|(group<> && operation_props) && {
     using GroupGen = internal::GroupGenerator<StreamGenerator>;
-    return Stream<GroupGen, Tag>(GroupGen(generator_, operation_props.group_size), Tag);
+    return Stream<GroupGen, Tag>(GroupGen(std::move(generator_), operation_props.group_size), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+Stream<internal::SpanGroupGenerator<StreamGenerator>, Tag>
+Stream<StreamGenerator, Tag>::operator|(group<dynamic_group_size, reuse_buffer_t> && operation_props) && {
+    using GroupGen = internal::SpanGroupGenerator<StreamGenerator>;
+    return Stream<GroupGen, Tag>(GroupGen(std::move(generator_), operation_props.group_size,
+                                          options_.memory_resource), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Allocator>
+Stream<internal::GroupGenerator<StreamGenerator, internal::rebind_alloc_t<Allocator, typename StreamGenerator::value_type>>, Tag>
+Stream<StreamGenerator, Tag>::operator|(group<dynamic_group_size, Allocator> && operation_props) && {
+    using GroupAllocator = internal::rebind_alloc_t<Allocator, value_type>;
+    using GroupGen = internal::GroupGenerator<StreamGenerator, GroupAllocator>;
+    return Stream<GroupGen, Tag>(GroupGen(std::move(generator_), operation_props.group_size,
+                                          GroupAllocator(operation_props.storage)), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<size_t GroupSize>
+Stream<internal::FixedGroupGenerator<StreamGenerator, GroupSize>, Tag>
+Stream<StreamGenerator, Tag>::operator|(group<GroupSize> && unused) && {
+    using GroupGen = internal::FixedGroupGenerator<StreamGenerator, GroupSize>;
+    return Stream<GroupGen, Tag>(GroupGen(std::move(generator_)), Tag, options_);
 }
 
 template<class StreamGenerator, StreamTag Tag>
 template<class Transform>
-Stream<internal::MapGenerator<StreamGenerator, Transform>, Tag>
-Stream<StreamGenerator, Tag>::operator|(map<Transform> && operation_props) {
-    using MapGen = internal::MapGenerator<StreamGenerator, Transform>;
-    return Stream<MapGen, Tag>(MapGen(generator_, operation_props.transform), Tag);
+Stream<typename internal::map_stage<StreamGenerator, Transform>::type, Tag>
+Stream<StreamGenerator, Tag>::operator|(map<Transform> && operation_props) && {
+    using MapStage = internal::map_stage<StreamGenerator, Transform>;
+    return Stream<typename MapStage::type, Tag>(
+            MapStage::make(std::move(generator_), std::move(operation_props.transform), options_.memory_resource),
+            Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Transform>
+Stream<internal::ParallelMapGenerator<StreamGenerator, Transform>, Tag>
+Stream<StreamGenerator, Tag>::operator|(par_map<Transform> && operation_props) && {
+    using ParMapGen = internal::ParallelMapGenerator<StreamGenerator, Transform>;
+    return Stream<ParMapGen, Tag>(ParMapGen(std::move(generator_), std::move(operation_props.transform),
+                                            operation_props.threads, operation_props.window), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+Stream<internal::WindowGenerator<StreamGenerator>, Tag>
+Stream<StreamGenerator, Tag>::operator|(window<> && operation_props) && {
+    using WindowGen = internal::WindowGenerator<StreamGenerator>;
+    return Stream<WindowGen, Tag>(WindowGen(std::move(generator_), operation_props.size, operation_props.step,
+                                            options_.memory_resource), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Aggregate>
+Stream<internal::WindowAggregateGenerator<StreamGenerator, Aggregate>, Tag>
+Stream<StreamGenerator, Tag>::operator|(window<Aggregate> && operation_props) && {
+    using WindowGen = internal::WindowAggregateGenerator<StreamGenerator, Aggregate>;
+    return Stream<WindowGen, Tag>(WindowGen(std::move(generator_), operation_props.size, operation_props.step,
+                                            operation_props.aggregate), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Compare>
+Stream<internal::SortedGenerator<StreamGenerator, Compare>, Tag>
+Stream<StreamGenerator, Tag>::operator|(sorted<Compare> && operation_props) && {
+    static_assert(Tag == StreamTag::Finite, "Operation sorted cannot be performed on infinite stream.");
+    using SortedGen = internal::SortedGenerator<StreamGenerator, Compare>;
+    return Stream<SortedGen, Tag>(SortedGen(std::move(generator_), std::move(operation_props.compare),
+                                            operation_props.memory_budget), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class KeyFunction, class Aggregator, class Hash>
+Stream<internal::AggregateByGenerator<StreamGenerator, KeyFunction, Aggregator, Hash>, Tag>
+Stream<StreamGenerator, Tag>::operator|(aggregate_by<KeyFunction, Aggregator, Hash> && operation_props) && {
+    static_assert(Tag == StreamTag::Finite, "Operation aggregate_by cannot be performed on infinite stream.");
+    using AggregateGen = internal::AggregateByGenerator<StreamGenerator, KeyFunction, Aggregator, Hash>;
+    return Stream<AggregateGen, Tag>(AggregateGen(std::move(generator_), std::move(operation_props.key_function),
+                                                  std::move(operation_props.aggregator),
+                                                  std::move(operation_props.hash)), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+Stream<internal::AsyncBufferGenerator<StreamGenerator>, Tag>
+Stream<StreamGenerator, Tag>::operator|(async_buffer && operation_props) && {
+    using AsyncGen = internal::AsyncBufferGenerator<StreamGenerator>;
+    return Stream<AsyncGen, Tag>(AsyncGen(std::move(generator_), operation_props.capacity), Tag, options_);
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<bool Enabled>
+std::conditional_t<Enabled, Stream<internal::ProfiledGenerator<StreamGenerator>, Tag>, Stream<StreamGenerator, Tag>>
+Stream<StreamGenerator, Tag>::operator|(profile<Enabled> && operation_props) && {
+    if constexpr (Enabled) {
+        using ProfiledGen = internal::ProfiledGenerator<StreamGenerator>;
+        stage_stats & stats = operation_props.report.add_stage(operation_props.name);
+        return Stream<ProfiledGen, Tag>(ProfiledGen(std::move(generator_), stats), Tag, options_);
+    } else {
+        return std::move(*this);
+    }
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Generator>
+auto Stream<StreamGenerator, Tag>::sum_of(Generator & gen, SummationOrder order) -> std::optional<value_type> {
+    std::optional<value_type> opt = gen();
+    if (!opt.has_value()) {
+        return std::nullopt;
+    }
+    if constexpr (internal::can_reduce_blocks<Generator>::value) {
+        if (std::is_integral<value_type>::value || order == SummationOrder::Any) {
+            return internal::reduce_blocks<internal::ReduceOp::Sum>(gen, opt.value());
+        }
+    }
+    value_type & stream_sum = opt.value();
+    internal::for_each_until(gen, [&](auto && value) {
+        stream_sum += value;
+        return false;
+    });
+    return opt;
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Result, class Generator, class Reduce>
+std::optional<Result>
+Stream<StreamGenerator, Tag>::reduce_of(Generator & gen, Reduce & operation_props) {
+    std::optional<value_type> opt = gen();
+    if (!opt.has_value()) {
+        return std::nullopt;
+    }
+    Result result = internal::invoke_identity<Result>(operation_props.identity, std::move(opt.value()));
+    internal::for_each_until(gen, [&](auto && value) {
+        result = operation_props.accumulator(std::move(result), std::forward<decltype(value)>(value));
+        return false;
+    });
+    return result;
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class Allocator, class Generator>
+auto Stream<StreamGenerator, Tag>::to_vector_of(Generator & gen, const Allocator & allocator)
+-> std::vector<value_type, Allocator> {
+    std::vector<value_type, Allocator> vec(allocator);
+    SizeHint hint = internal::size_hint_of(gen);
+    if (hint.is_exact()) {
+        vec.reserve(hint.value);
+    }
+    internal::for_each_until(gen, [&](auto && value) {
+        vec.push_back(std::forward<decltype(value)>(value));
+        return false;
+    });
+    return vec;
+}
+
+template<class StreamGenerator, StreamTag Tag>
+template<class U, class Combiner>
+std::optional<U>
+Stream<StreamGenerator, Tag>::combine_partials(std::vector<std::optional<U>> && partials, Combiner && combiner) {
+    std::optional<U> result;
+    for (std::optional<U> & partial : partials) {
+        if (!partial.has_value()) {
+            continue;
+        }
+        if (result.has_value()) {
+            result = combiner(std::move(result.value()), std::move(partial.value()));
+        } else {
+            result = std::move(partial);
+        }
+    }
+    return result;
 }
 
 // Deduction guides
@@ -350,6 +1507,26 @@ typename std::enable_if_t<!internal::is_value_generator<Container>::value &&
                           std::is_move_constructible<Container>::value, Container> * = nullptr) ->
 Stream<internal::ContainerGenerator<Container>, StreamTag::Finite>;
 
+template<class Iterator>
+explicit Stream(range_view<Iterator> range) ->
+Stream<internal::ViewGenerator<Iterator>, StreamTag::Finite>;
+
+template<class Reader>
+explicit Stream(const line_source<Reader> & source) ->
+Stream<internal::LineGenerator<Reader>, StreamTag::Finite>;
+
+template<class T, class WaitStrategy>
+explicit Stream(channel<T, WaitStrategy> & source) ->
+Stream<internal::ChannelGenerator<T, WaitStrategy>, StreamTag::Finite>;
+
+#ifdef CPPSTREAM_MMAP
+
+template<class T>
+explicit Stream(const mapped_file<T> & file) ->
+Stream<internal::MappedFileGenerator<T>, StreamTag::Finite>;
+
+#endif
+
 template<class T>
 Stream(std::initializer_list<T>
 il) ->
@@ -365,6 +1542,30 @@ typename std::enable_if_t<!internal::is_value_generator<T>::value &&
                           !internal::is_container<T>::value, T> * = nullptr) ->
 Stream<internal::PackGenerator<T>, StreamTag::Finite>;
 
+#ifdef CPPSTREAM_MMAP
+
+/**
+ * Maps file of packed records of type T read-only and creates stream reading them in place.
+ * Records are loaded lazily, so the first element is available before the whole file is read.
+ * @example auto s = from_mmap<Record>("records.bin") | skip(1000) | get(10)
+ */
+template<class T>
+Stream<internal::MappedFileGenerator<T>, StreamTag::Finite> from_mmap(const std::string & path) {
+    return Stream(mapped_file<T>(path));
+}
+
+/**
+ * Creates stream of elements of type T written by write_binary, read in place from the mapped file.
+ * Throws if the file was not written by write_binary or holds elements of a different size.
+ * @example auto s = from_binary<Record>("checkpoint.bin")
+ */
+template<class T>
+Stream<internal::MappedFileGenerator<T>, StreamTag::Finite> from_binary(const std::string & path) {
+    return Stream(internal::open_binary_file<T>(path));
+}
+
+#endif
+
 }
 
 #endif //STREAM_H
@@ -0,0 +1,166 @@
+#ifndef STREAM_PROFILE_H
+#define STREAM_PROFILE_H
+
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include "stream_utils.h"
+
+#ifndef CPPSTREAM_PROFILING
+#define CPPSTREAM_PROFILING 0
+#endif
+
+namespace cppstream {
+
+/**
+ * Whether profile probes record anything unless told otherwise. Set by defining CPPSTREAM_PROFILING to 1.
+ */
+constexpr bool profiling_enabled = CPPSTREAM_PROFILING != 0;
+
+/**
+ * What a profile probe observed at its point of the pipeline
+ */
+struct stage_stats {
+    std::string name;
+    // Elements which passed the probe
+    size_t emitted = 0;
+    // Time spent in the pipeline up to the probe, including earlier stages
+    std::chrono::nanoseconds time{0};
+};
+
+/**
+ * Report collecting statistics of profile probes in order of their insertion into pipelines.
+ * Elements pulled by a stage are the elements emitted at the previous probe.
+ */
+class pipeline_profile {
+public:
+    stage_stats & add_stage(std::string name) {
+        stages_.push_back(stage_stats{std::move(name)});
+        return stages_.back();
+    }
+
+    const std::deque<stage_stats> & stages() const { return stages_; }
+
+    /**
+     * Prints a row per probe with elements pulled from the previous probe, elements emitted,
+     * their ratio and time spent between the previous probe and this one
+     */
+    void print(std::ostream & os) const {
+        os << std::left << std::setw(20) << "stage" << std::right << std::setw(14) << "pulled"
+           << std::setw(14) << "emitted" << std::setw(13) << "selectivity" << std::setw(14) << "time, ms" << '\n';
+        const stage_stats * previous = nullptr;
+        for (const stage_stats & stage : stages_) {
+            os << std::left << std::setw(20) << stage.name << std::right;
+            if (previous != nullptr) {
+                double selectivity = previous->emitted == 0
+                                     ? 0.0 : static_cast<double>(stage.emitted) / previous->emitted;
+                os << std::setw(14) << previous->emitted << std::setw(14) << stage.emitted
+                   << std::setw(13) << std::fixed << std::setprecision(3) << selectivity;
+            } else {
+                os << std::setw(14) << "-" << std::setw(14) << stage.emitted << std::setw(13) << "-";
+            }
+            std::chrono::nanoseconds own_time = stage.time - (previous != nullptr ? previous->time
+                                                                                  : std::chrono::nanoseconds(0));
+            os << std::setw(14) << std::fixed << std::setprecision(3)
+               << std::chrono::duration<double, std::milli>(own_time).count() << '\n';
+            previous = &stage;
+        }
+    }
+
+private:
+    std::deque<stage_stats> stages_;
+};
+
+}
+
+namespace cppstream::internal {
+
+/**
+ * Passes elements of parent generator through, counting them and timing the parent.
+ * Slices taken for parallel terminals read the parent directly and are not profiled.
+ */
+template<class ParentGenerator>
+class ProfiledGenerator {
+    using clock = std::chrono::steady_clock;
+public:
+    using value_type = typename ParentGenerator::value_type;
+
+    ProfiledGenerator(ParentGenerator && parent_gen, stage_stats & stats)
+            : parent_gen_(std::move(parent_gen)), stats_(&stats) {}
+
+    ProfiledGenerator(const ProfiledGenerator & other) = default;
+
+    ProfiledGenerator(ProfiledGenerator && other) = default;
+
+    ~ProfiledGenerator() = default;
+
+    ProfiledGenerator & operator=(const ProfiledGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        clock::time_point start = clock::now();
+        std::optional<value_type> opt = parent_gen_();
+        stats_->time += clock::now() - start;
+        stats_->emitted += opt.has_value() ? 1 : 0;
+        return opt;
+    }
+
+    SizeHint size_hint() const {
+        return internal::size_hint_of(parent_gen_);
+    }
+
+    /**
+     * Time spent by the sink, which runs the following stages, is excluded from the time of the parent
+     */
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        clock::duration in_sink(0);
+        clock::time_point start = clock::now();
+        bool stopped = internal::for_each_until(parent_gen_, [&](auto && value) {
+            ++stats_->emitted;
+            clock::time_point sink_start = clock::now();
+            bool stop = sink(std::forward<decltype(value)>(value));
+            in_sink += clock::now() - sink_start;
+            return stop;
+        });
+        stats_->time += clock::now() - start - in_sink;
+        return stopped;
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<has_next_contiguous<Parent>::value>>
+    span<const value_type> next_contiguous(size_t max_count) {
+        clock::time_point start = clock::now();
+        span<const value_type> block = parent_gen_.next_contiguous(max_count);
+        stats_->time += clock::now() - start;
+        stats_->emitted += block.size();
+        return block;
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<has_advance<Parent>::value>>
+    size_t advance(size_t amount) {
+        return parent_gen_.advance(amount);
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<is_sliceable<Parent>::value>>
+    size_t slice_extent() const {
+        return parent_gen_.slice_extent();
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<is_sliceable<Parent>::value>>
+    auto slice(size_t first, size_t count) const {
+        return parent_gen_.slice(first, count);
+    }
+
+private:
+    ParentGenerator parent_gen_;
+    stage_stats * stats_;
+};
+
+}
+
+#endif //STREAM_PROFILE_H
@@ -0,0 +1,195 @@
+#ifndef STREAM_SIMD_H
+#define STREAM_SIMD_H
+
+#include <cstring>
+#include <type_traits>
+#include "stream_utils.h"
+
+#if defined(__GNUC__)
+#define CPPSTREAM_VECTOR_EXTENSIONS 1
+#if defined(__x86_64__) || defined(__i386__)
+#define CPPSTREAM_X86_KERNELS 1
+#endif
+#endif
+
+namespace cppstream::internal {
+
+/**
+ * Arithmetic types which reduction kernels operate on
+ */
+template<class T>
+struct is_simd_arithmetic
+        : std::bool_constant<(std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+                             std::is_same<T, float>::value ||
+                             std::is_same<T, double>::value> {
+};
+
+enum class ReduceOp {
+    Sum, Min, Max
+};
+
+template<ReduceOp Op, class T>
+inline T reduce_scalar(T lhs, T rhs) {
+    if constexpr (Op == ReduceOp::Sum) {
+        return lhs + rhs;
+    } else if constexpr (Op == ReduceOp::Min) {
+        return rhs < lhs ? rhs : lhs;
+    } else {
+        return lhs < rhs ? rhs : lhs;
+    }
+}
+
+#ifdef CPPSTREAM_VECTOR_EXTENSIONS
+
+/**
+ * Reduces block with four independent vector accumulators of given width.
+ * Always inlined, so that it is compiled for the instruction set of the calling kernel.
+ */
+template<ReduceOp Op, class T, size_t VectorBytes>
+__attribute__((always_inline)) inline T reduce_block_vectorized(const T * data, size_t size, T init) {
+    typedef T vector_type __attribute__((vector_size(VectorBytes)));
+    constexpr size_t lanes = VectorBytes / sizeof(T);
+    constexpr size_t accumulators = 4;
+    constexpr size_t step = lanes * accumulators;
+
+    T result = init;
+    size_t i = 0;
+    if (size >= step) {
+        vector_type acc[accumulators];
+        for (size_t k = 0; k < accumulators; ++k) {
+            std::memcpy(&acc[k], data + k * lanes, VectorBytes);
+        }
+        for (i = step; i + step <= size; i += step) {
+            for (size_t k = 0; k < accumulators; ++k) {
+                vector_type value;
+                std::memcpy(&value, data + i + k * lanes, VectorBytes);
+                if constexpr (Op == ReduceOp::Sum) {
+                    acc[k] = acc[k] + value;
+                } else if constexpr (Op == ReduceOp::Min) {
+                    acc[k] = value < acc[k] ? value : acc[k];
+                } else {
+                    acc[k] = acc[k] < value ? value : acc[k];
+                }
+            }
+        }
+        for (size_t k = 0; k < accumulators; ++k) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                result = reduce_scalar<Op>(result, static_cast<T>(acc[k][lane]));
+            }
+        }
+    }
+    for (; i < size; ++i) {
+        result = reduce_scalar<Op>(result, data[i]);
+    }
+    return result;
+}
+
+template<ReduceOp Op, class T>
+T reduce_block_default(const T * data, size_t size, T init) {
+    return reduce_block_vectorized<Op, T, 16>(data, size, init);
+}
+
+#ifdef CPPSTREAM_X86_KERNELS
+
+template<ReduceOp Op, class T>
+__attribute__((target("avx2"))) T reduce_block_avx2(const T * data, size_t size, T init) {
+    return reduce_block_vectorized<Op, T, 32>(data, size, init);
+}
+
+inline bool cpu_supports_avx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#endif
+
+#else
+
+template<ReduceOp Op, class T>
+T reduce_block_default(const T * data, size_t size, T init) {
+    T acc[4] = {init, init, init, init};
+    size_t i = 0;
+    if (size >= 4) {
+        acc[1] = data[1];
+        acc[2] = data[2];
+        acc[3] = data[3];
+        acc[0] = reduce_scalar<Op>(acc[0], data[0]);
+        for (i = 4; i + 4 <= size; i += 4) {
+            for (size_t k = 0; k < 4; ++k) {
+                acc[k] = reduce_scalar<Op>(acc[k], data[i + k]);
+            }
+        }
+        acc[0] = reduce_scalar<Op>(reduce_scalar<Op>(acc[0], acc[1]), reduce_scalar<Op>(acc[2], acc[3]));
+    }
+    for (; i < size; ++i) {
+        acc[0] = reduce_scalar<Op>(acc[0], data[i]);
+    }
+    return acc[0];
+}
+
+#endif
+
+/**
+ * Reduces block with the widest kernel supported by the CPU
+ */
+template<ReduceOp Op, class T>
+T reduce_block(const T * data, size_t size, T init) {
+#ifdef CPPSTREAM_X86_KERNELS
+    if (cpu_supports_avx2()) {
+        return reduce_block_avx2<Op>(data, size, init);
+    }
+#endif
+    return reduce_block_default<Op>(data, size, init);
+}
+
+/**
+ * Maximal amount of elements handed to a kernel at once
+ */
+constexpr size_t reduce_block_size = 4096;
+
+/**
+ * Kernels are used only for generators exposing their storage directly.
+ * Materializing elements of other generators into blocks costs more than a fused scalar push loop.
+ */
+template<class Generator>
+struct can_reduce_blocks
+        : std::bool_constant<is_simd_arithmetic<typename Generator::value_type>::value &&
+                             has_next_contiguous<Generator>::value> {
+};
+
+/**
+ * Reduces the remaining elements of the generator block by block, starting from init
+ */
+template<ReduceOp Op, class Generator>
+typename Generator::value_type reduce_blocks(Generator & gen, typename Generator::value_type init) {
+    using value_type = typename Generator::value_type;
+    value_type result = init;
+    span<const value_type> block;
+    while (!(block = gen.next_contiguous(reduce_block_size)).empty()) {
+        result = reduce_block<Op>(block.data(), block.size(), result);
+    }
+    return result;
+}
+
+/**
+ * Counts the remaining elements of the generator, block by block when possible
+ */
+template<class Generator>
+size_t count_elements(Generator & gen) {
+    size_t count = 0;
+    if constexpr (has_next_contiguous<Generator>::value) {
+        while (size_t block_size = gen.next_contiguous(reduce_block_size).size()) {
+            count += block_size;
+        }
+    } else {
+        internal::for_each_until(gen, [&count](auto &&) {
+            ++count;
+            return false;
+        });
+    }
+    return count;
+}
+
+}
+
+#endif //STREAM_SIMD_H
@@ -1,10 +1,251 @@
 #ifndef STREAM_UTILS_H
 #define STREAM_UTILS_H
 
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+
+namespace cppstream {
+
+/**
+ * Non-owning view of a contiguous sequence of elements, a minimal stand-in for C++20 std::span
+ */
+template<class T>
+class span {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T *;
+
+    span() : data_(nullptr), size_(0) {}
+
+    span(T * data, size_t size) : data_(data), size_(size) {}
+
+    T * data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    T & operator[](size_t idx) const { return data_[idx]; }
+
+    iterator begin() const { return data_; }
+
+    iterator end() const { return data_ + size_; }
+
+    span first(size_t count) const { return span(data_, count); }
+
+    span subspan(size_t offset) const { return span(data_ + offset, size_ - offset); }
+
+private:
+    T * data_;
+    size_t size_;
+};
+
+/**
+ * Vector of at most Capacity elements stored inline, so that it never allocates.
+ * Elements have to be default constructible.
+ */
+template<class T, size_t Capacity>
+class inline_vector {
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    inline_vector() : items_(), size_(0) {}
+
+    inline_vector(std::initializer_list<T> items) : items_(), size_(0) {
+        for (const T & item : items) {
+            push_back(item);
+        }
+    }
+
+    T * data() { return items_.data(); }
+
+    const T * data() const { return items_.data(); }
+
+    size_t size() const { return size_; }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    bool empty() const { return size_ == 0; }
+
+    bool full() const { return size_ == Capacity; }
+
+    T & operator[](size_t idx) { return items_[idx]; }
+
+    const T & operator[](size_t idx) const { return items_[idx]; }
+
+    iterator begin() { return items_.data(); }
+
+    iterator end() { return items_.data() + size_; }
+
+    const_iterator begin() const { return items_.data(); }
+
+    const_iterator end() const { return items_.data() + size_; }
+
+    template<class U>
+    void push_back(U && item) { items_[size_++] = std::forward<U>(item); }
+
+    void clear() { size_ = 0; }
+
+    bool operator==(const inline_vector & other) const {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+    bool operator!=(const inline_vector & other) const { return !(*this == other); }
+
+private:
+    std::array<T, Capacity> items_;
+    size_t size_;
+};
+
+/**
+ * What is known about the amount of elements a generator has left
+ */
+struct SizeHint {
+    enum class Kind {
+        Exact, UpperBound, Unknown
+    };
+
+    Kind kind;
+    size_t value;
+
+    static SizeHint exact(size_t value) { return {Kind::Exact, value}; }
+
+    static SizeHint upper_bound(size_t value) { return {Kind::UpperBound, value}; }
+
+    static SizeHint unknown() { return {Kind::Unknown, 0}; }
+
+    bool is_exact() const { return kind == Kind::Exact; }
+
+    bool is_known() const { return kind != Kind::Unknown; }
+
+    bool operator==(const SizeHint & other) const { return kind == other.kind && value == other.value; }
+
+    bool operator!=(const SizeHint & other) const { return !(*this == other); }
+};
+
+}
 
 namespace cppstream::internal {
 
+/**
+ * Settings a stream passes on to the streams created from it
+ */
+struct StreamOptions {
+    // Amount of threads terminal operations may run on
+    size_t threads = 1;
+    // Resource internal buffers of stages are allocated from
+    std::pmr::memory_resource * memory_resource = std::pmr::get_default_resource();
+};
+
+/**
+ * Allocator of the same kind as given one for elements of type T. Has no type if Allocator is not an allocator.
+ */
+template<class Allocator, class T, class = void>
+struct rebind_alloc {
+};
+
+template<class Allocator, class T>
+struct rebind_alloc<Allocator, T, std::void_t<typename Allocator::value_type,
+        decltype(std::declval<Allocator &>().allocate(size_t()))>> {
+    using type = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+};
+
+template<class Allocator, class T>
+using rebind_alloc_t = typename rebind_alloc<Allocator, T>::type;
+
+template<class Container, class = void>
+struct has_allocator : std::false_type {
+};
+
+template<class Container>
+struct has_allocator<Container, std::void_t<typename Container::allocator_type>> : std::true_type {
+};
+
+/**
+ * Copies container keeping its allocator, so that copies of containers placed in an arena stay in that arena
+ */
+template<class Container>
+Container copy_container(const Container & container) {
+    if constexpr (has_allocator<Container>::value) {
+        using allocator_type = typename Container::allocator_type;
+        if constexpr (!std::allocator_traits<allocator_type>::is_always_equal::value) {
+            return Container(container, container.get_allocator());
+        }
+    }
+    return Container(container);
+}
+
+/**
+ * Default identity of reduce, which casts the first element to the result type U.
+ * With U = void the result type is deduced from the accumulator.
+ */
+template<class U>
+struct cast_identity {
+    template<class T>
+    U operator()(T && value) const { return static_cast<U>(std::forward<T>(value)); }
+};
+
+/**
+ * Marks reduce without a combiner of partial results
+ */
+struct no_combiner {
+};
+
+template<class Combiner>
+bool has_combiner(const Combiner & combiner) {
+    if constexpr (std::is_same<Combiner, no_combiner>::value) {
+        return false;
+    } else if constexpr (std::is_constructible<bool, const Combiner &>::value) {
+        return static_cast<bool>(combiner);
+    } else {
+        return true;
+    }
+}
+
+/**
+ * Result type of reduce over elements of type T: U if given explicitly,
+ * otherwise deduced from the identity or, for the default identity, from the accumulator
+ */
+template<class U, class Identity, class Accumulator, class T>
+struct reduce_result {
+    using type = U;
+};
+
+template<class Identity, class Accumulator, class T>
+struct reduce_result<void, Identity, Accumulator, T> {
+    using type = std::decay_t<std::invoke_result_t<Identity &, T>>;
+};
+
+template<class Accumulator, class T>
+struct reduce_result<void, cast_identity<void>, Accumulator, T> {
+    using type = std::decay_t<std::invoke_result_t<Accumulator &, T, T>>;
+};
+
+template<class U, class Identity, class Accumulator, class T>
+using reduce_result_t = typename reduce_result<U, Identity, Accumulator, T>::type;
+
+template<class U, class Identity, class T>
+U invoke_identity(Identity & identity, T && value) {
+    if constexpr (std::is_same<Identity, cast_identity<void>>::value) {
+        return static_cast<U>(std::forward<T>(value));
+    } else {
+        return identity(std::forward<T>(value));
+    }
+}
+
 template<class T, typename = void>
 struct is_value_generator : std::false_type {
 };
@@ -38,6 +279,193 @@ struct is_container<C,
         : std::true_type {
 };
 
+template<class C, typename = void>
+struct is_contiguous_container : std::false_type {
+};
+
+template<class C>
+struct is_contiguous_container<C,
+        typename std::enable_if_t<is_container<C>::value &&
+                                  std::is_pointer<decltype(std::declval<const C &>().data())>::value &&
+                                  std::is_integral<decltype(std::declval<const C &>().size())>::value>>
+        : std::true_type {
+};
+
+template<class C, typename = void>
+struct view_iterator {
+    using type = typename C::const_iterator;
+};
+
+template<class C>
+struct view_iterator<C, typename std::enable_if_t<is_contiguous_container<C>::value>> {
+    using type = decltype(std::declval<const C &>().data());
+};
+
+template<class C>
+using view_iterator_t = typename view_iterator<C>::type;
+
+template<class G, typename = void>
+struct has_for_each_until : std::false_type {
+};
+
+template<class G>
+struct has_for_each_until<G,
+        std::void_t<decltype(std::declval<G &>().for_each_until(
+                std::declval<bool (&)(const typename G::value_type &)>()))>>
+        : std::true_type {
+};
+
+/**
+ * Pushes elements of the generator to the sink until the sink returns true or the generator is exhausted.
+ * Uses generator's own push loop if it has one and falls back to pulling elements otherwise.
+ * @return true if the sink stopped the iteration
+ */
+template<class Generator, class Sink>
+bool for_each_until(Generator & gen, Sink && sink) {
+    if constexpr (has_for_each_until<Generator>::value) {
+        return gen.for_each_until(sink);
+    } else {
+        std::optional<typename Generator::value_type> opt;
+        while ((opt = gen())) {
+            if (sink(std::move(opt.value()))) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+template<class G, typename = void>
+struct has_size_hint : std::false_type {
+};
+
+template<class G>
+struct has_size_hint<G, std::void_t<decltype(std::declval<const G &>().size_hint())>> : std::true_type {
+};
+
+/**
+ * @return size hint of the generator or SizeHint::unknown() if it cannot tell
+ */
+template<class Generator>
+SizeHint size_hint_of(const Generator & gen) {
+    if constexpr (has_size_hint<Generator>::value) {
+        return gen.size_hint();
+    } else {
+        return SizeHint::unknown();
+    }
+}
+
+template<class G, typename = void>
+struct has_advance : std::false_type {
+};
+
+template<class G>
+struct has_advance<G, std::void_t<decltype(std::declval<G &>().advance(size_t()))>> : std::true_type {
+};
+
+/**
+ * Skips up to amount next elements of the generator.
+ * Random access generators skip in constant time, others discard elements one by one.
+ * @return amount of elements skipped, less than amount only if the generator is exhausted
+ */
+template<class Generator>
+size_t advance(Generator & gen, size_t amount) {
+    if constexpr (has_advance<Generator>::value) {
+        return gen.advance(amount);
+    } else {
+        size_t skipped = 0;
+        if (amount > 0) {
+            internal::for_each_until(gen, [&](auto &&) {
+                return ++skipped == amount;
+            });
+        }
+        return skipped;
+    }
+}
+
+template<class G, typename = void>
+struct is_sliceable : std::false_type {
+};
+
+/**
+ * Slices read elements in place and copy them, so generators of move-only elements are consumed sequentially
+ */
+template<class G>
+struct is_sliceable<G, std::void_t<decltype(std::declval<const G &>().slice_extent())>>
+        : std::is_copy_constructible<typename G::value_type> {
+};
+
+template<class G, typename = void>
+struct has_next_batch : std::false_type {
+};
+
+template<class G>
+struct has_next_batch<G,
+        std::void_t<decltype(std::declval<G &>().next_batch(std::declval<span<typename G::value_type>>()))>>
+        : std::true_type {
+};
+
+/**
+ * Fills leading elements of out with the next elements of the generator.
+ * Uses generator's own batched pull if it has one and falls back to pulling elements one by one otherwise.
+ * @return amount of elements written, less than out.size() only if the generator is exhausted
+ */
+template<class Generator>
+size_t next_batch(Generator & gen, span<typename Generator::value_type> out) {
+    if constexpr (has_next_batch<Generator>::value) {
+        return gen.next_batch(out);
+    } else {
+        size_t filled = 0;
+        std::optional<typename Generator::value_type> opt;
+        while (filled < out.size() && (opt = gen())) {
+            out[filled++] = std::move(opt.value());
+        }
+        return filled;
+    }
+}
+
+template<class G, typename = void>
+struct has_next_contiguous : std::false_type {
+};
+
+template<class G>
+struct has_next_contiguous<G, std::void_t<decltype(std::declval<G &>().next_contiguous(size_t()))>>
+        : std::true_type {
+};
+
+/**
+ * Copies leading elements of [current, end) to out and advances current past them
+ * @return amount of elements copied
+ */
+template<class Iterator, class T>
+size_t copy_batch(Iterator & current, Iterator end, span<T> out) {
+    if constexpr (std::is_base_of<std::random_access_iterator_tag,
+            typename std::iterator_traits<Iterator>::iterator_category>::value) {
+        size_t count = std::min(out.size(), static_cast<size_t>(end - current));
+        std::copy_n(current, count, out.begin());
+        current += count;
+        return count;
+    } else {
+        size_t filled = 0;
+        for (; filled < out.size() && current != end; ++filled, ++current) {
+            out[filled] = *current;
+        }
+        return filled;
+    }
+}
+
+/**
+ * Moves leading elements of [current, end) to out and advances current past them
+ * @return amount of elements moved
+ */
+template<class Iterator, class T>
+size_t move_batch(Iterator & current, Iterator end, span<T> out) {
+    std::move_iterator<Iterator> moving(current);
+    size_t count = copy_batch(moving, std::move_iterator<Iterator>(end), out);
+    current = moving.base();
+    return count;
+}
+
 template<class Generator>
 class InfiniteGenerator final {
 public:
@@ -59,45 +487,212 @@ public:
         return {value_generator_()};
     }
 
+    SizeHint size_hint() const {
+        return SizeHint::unknown();
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        while (!sink(value_generator_()));
+        return true;
+    }
+
+    size_t next_batch(span<value_type> out) {
+        for (value_type & value : out) {
+            value = value_generator_();
+        }
+        return out.size();
+    }
+
 private:
     Generator value_generator_;
 };
 
+template<class Iterator>
+class ViewGenerator final {
+public:
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    ViewGenerator(Iterator first, Iterator last)
+            : current_(first), end_(last) {}
+
+    ViewGenerator(const ViewGenerator & other) = default;
+
+    ~ViewGenerator() = default;
+
+    ViewGenerator & operator=(const ViewGenerator & other) = default;
+
+    std::optional<value_type> operator()() {
+        if (current_ == end_) return std::nullopt;
+
+        return {*(current_++)};
+    }
+
+    /**
+     * Exact amount of remaining elements. Takes linear time for ranges without random access iterators.
+     */
+    SizeHint size_hint() const {
+        return SizeHint::exact(static_cast<size_t>(std::distance(current_, end_)));
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        while (current_ != end_) {
+            if (sink(*(current_++))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t next_batch(span<value_type> out) {
+        return copy_batch(current_, end_, out);
+    }
+
+    /**
+     * Returns up to max_count next elements in place and skips them
+     */
+    template<class It = Iterator,
+            typename = std::enable_if_t<std::is_pointer<It>::value>>
+    span<const value_type> next_contiguous(size_t max_count) {
+        size_t count = std::min(max_count, static_cast<size_t>(end_ - current_));
+        span<const value_type> block(current_, count);
+        current_ += count;
+        return block;
+    }
+
+    /**
+     * Skips up to amount next elements in constant time
+     */
+    template<class It = Iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    size_t advance(size_t amount) {
+        size_t skipped = std::min(amount, static_cast<size_t>(end_ - current_));
+        current_ += skipped;
+        return skipped;
+    }
+
+    /**
+     * Amount of remaining elements which can be split into slices
+     */
+    template<class It = Iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    size_t slice_extent() const {
+        return static_cast<size_t>(end_ - current_);
+    }
+
+    /**
+     * @return generator of count remaining elements starting from first, which reads them in place
+     */
+    template<class It = Iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    ViewGenerator<Iterator> slice(size_t first, size_t count) const {
+        return ViewGenerator<Iterator>(current_ + first, current_ + first + count);
+    }
+
+private:
+    Iterator current_;
+    Iterator end_;
+};
+
 template<class T>
 class PackGenerator final {
-    using container_iterator = typename std::vector<T>::const_reverse_iterator;
+    using container_iterator = typename std::vector<T>::reverse_iterator;
+    using const_container_iterator = typename std::vector<T>::const_reverse_iterator;
 public:
     using value_type = T;
 
     PackGenerator() = default;
 
-    PackGenerator(const PackGenerator & other) = default;
+    PackGenerator(const PackGenerator & other)
+            : container_(other.container_),
+              current_(container_.rbegin() + (other.current_ - other.container_.rbegin())),
+              end_(container_.rend()) {}
 
     PackGenerator(PackGenerator && other)
             : container_(std::move(other.container_)),
-              current_(container_.cbegin()),
-              end_(container_.cend()) {}
+              current_(container_.rbegin()),
+              end_(container_.rend()) {}
 
     ~PackGenerator() = default;
 
-    PackGenerator & operator=(const PackGenerator & other) = default;
+    PackGenerator & operator=(const PackGenerator & other) {
+        container_ = other.container_;
+        current_ = container_.rbegin() + (other.current_ - other.container_.rbegin());
+        end_ = container_.rend();
+        return *this;
+    }
 
     PackGenerator & operator=(PackGenerator && other) {
         container_ = std::move(other.container_);
-        current_ = container_.cbegin();
-        end_ = container_.cend();
+        current_ = container_.rbegin();
+        end_ = container_.rend();
+        return *this;
     }
 
     void push_back(T value) {
-        container_.push_back(value);
-        current_ = container_.crbegin();
-        end_ = container_.crend();
+        container_.push_back(std::move(value));
+        current_ = container_.rbegin();
+        end_ = container_.rend();
     }
 
     std::optional<value_type> operator()() {
         if (current_ == end_) return std::nullopt;
 
-        return {*(current_++)};
+        return {std::move(*(current_++))};
+    }
+
+    SizeHint size_hint() const {
+        return SizeHint::exact(static_cast<size_t>(std::distance(current_, end_)));
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        while (current_ != end_) {
+            if (sink(std::move(*(current_++)))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t next_batch(span<value_type> out) {
+        return move_batch(current_, end_, out);
+    }
+
+    /**
+     * Skips up to amount next elements in constant time
+     */
+    template<class It = container_iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    size_t advance(size_t amount) {
+        size_t skipped = std::min(amount, static_cast<size_t>(end_ - current_));
+        current_ += skipped;
+        return skipped;
+    }
+
+    /**
+     * Amount of remaining elements which can be split into slices
+     */
+    template<class It = container_iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    size_t slice_extent() const {
+        return static_cast<size_t>(end_ - current_);
+    }
+
+    /**
+     * @return generator of count remaining elements starting from first, which reads them in place
+     */
+    template<class It = container_iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    ViewGenerator<const_container_iterator> slice(size_t first, size_t count) const {
+        return ViewGenerator<const_container_iterator>(current_ + first, current_ + first + count);
     }
 
 private:
@@ -108,29 +703,30 @@ private:
 
 template<class Container>
 class ContainerGenerator final {
-    using container_iterator = typename Container::const_iterator;
+    using container_iterator = typename Container::iterator;
+    using const_container_iterator = typename Container::const_iterator;
 public:
     using value_type = typename Container::value_type;
 
     ContainerGenerator(const Container & container)
             : container_(container),
-              current_(container_.cbegin()),
-              end_(container_.cend()) {}
+              current_(container_.begin()),
+              end_(container_.end()) {}
 
     ContainerGenerator(Container && container)
             : container_(std::move(container)),
-              current_(container_.cbegin()),
-              end_(container_.cend()) {}
+              current_(container_.begin()),
+              end_(container_.end()) {}
 
     ContainerGenerator(const ContainerGenerator & other)
-            : container_(other.container_),
-              current_(container_.cbegin()),
-              end_(container_.cend()) {}
+            : container_(copy_container(other.container_)),
+              current_(container_.begin()),
+              end_(container_.end()) {}
 
     ContainerGenerator(ContainerGenerator && other)
             : container_(std::move(other.container_)),
-              current_(container_.cbegin()),
-              end_(container_.cend()) {}
+              current_(container_.begin()),
+              end_(container_.end()) {}
 
     ~ContainerGenerator() = default;
 
@@ -138,18 +734,85 @@ public:
         container_ = other.container_;
         current_ = container_.begin();
         end_ = container_.end();
+        return *this;
     }
 
     ContainerGenerator & operator=(ContainerGenerator && other) {
         container_ = std::move(other.container_);
         current_ = container_.begin();
         end_ = container_.end();
+        return *this;
     }
 
     std::optional<value_type> operator()() {
         if (current_ == end_) return std::nullopt;
 
-        return {*(current_++)};
+        return {std::move(*(current_++))};
+    }
+
+    /**
+     * Exact amount of remaining elements. Takes linear time for containers without random access iterators.
+     */
+    SizeHint size_hint() const {
+        return SizeHint::exact(static_cast<size_t>(std::distance(current_, end_)));
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        while (current_ != end_) {
+            if (sink(std::move(*(current_++)))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t next_batch(span<value_type> out) {
+        return move_batch(current_, end_, out);
+    }
+
+    /**
+     * Returns up to max_count next elements in place and skips them
+     */
+    template<class C = Container,
+            typename = std::enable_if_t<is_contiguous_container<C>::value>>
+    span<const value_type> next_contiguous(size_t max_count) {
+        size_t count = std::min(max_count, static_cast<size_t>(end_ - current_));
+        span<const value_type> block(container_.data() + (current_ - container_.begin()), count);
+        current_ += count;
+        return block;
+    }
+
+    /**
+     * Skips up to amount next elements in constant time
+     */
+    template<class It = container_iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    size_t advance(size_t amount) {
+        size_t skipped = std::min(amount, static_cast<size_t>(end_ - current_));
+        current_ += skipped;
+        return skipped;
+    }
+
+    /**
+     * Amount of remaining elements which can be split into slices
+     */
+    template<class It = container_iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    size_t slice_extent() const {
+        return static_cast<size_t>(end_ - current_);
+    }
+
+    /**
+     * @return generator of count remaining elements starting from first, which reads them in place
+     */
+    template<class It = container_iterator,
+            typename = std::enable_if_t<std::is_base_of<std::random_access_iterator_tag,
+                    typename std::iterator_traits<It>::iterator_category>::value>>
+    ViewGenerator<const_container_iterator> slice(size_t first, size_t count) const {
+        return ViewGenerator<const_container_iterator>(current_ + first, current_ + first + count);
     }
 
 private:
@@ -166,6 +829,9 @@ public:
     SkipGenerator(const ParentGenerator & parent_gen, size_t amount)
             : parent_gen_(parent_gen), amount_to_skip_(amount), skipped_(false) {}
 
+    SkipGenerator(ParentGenerator && parent_gen, size_t amount)
+            : parent_gen_(std::move(parent_gen)), amount_to_skip_(amount), skipped_(false) {}
+
     SkipGenerator(const SkipGenerator & other) = default;
 
     SkipGenerator(SkipGenerator && other)
@@ -178,21 +844,79 @@ public:
     SkipGenerator & operator=(const SkipGenerator & other) = delete;
 
     std::optional<value_type> operator()() {
-        if (!skipped_) {
-            std::optional<value_type> opt;
-            size_t i = 0;
-            while (i < amount_to_skip_ && (opt = parent_gen_())) {
-                ++i;
-            }
-            skipped_ = true;
-            if (i < amount_to_skip_) {
-                return std::nullopt;
-            }
+        if (!skip_leading()) {
+            return std::nullopt;
         }
         return parent_gen_();
     }
 
+    SizeHint size_hint() const {
+        SizeHint parent_hint = internal::size_hint_of(parent_gen_);
+        if (skipped_ || !parent_hint.is_known()) {
+            return parent_hint;
+        }
+        parent_hint.value -= std::min(parent_hint.value, amount_to_skip_);
+        return parent_hint;
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        if (!skip_leading()) {
+            return false;
+        }
+        return internal::for_each_until(parent_gen_, sink);
+    }
+
+    size_t next_batch(span<value_type> out) {
+        if (!skip_leading()) {
+            return 0;
+        }
+        return internal::next_batch(parent_gen_, out);
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<has_advance<Parent>::value>>
+    size_t advance(size_t amount) {
+        if (!skip_leading()) {
+            return 0;
+        }
+        return parent_gen_.advance(amount);
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<has_next_contiguous<Parent>::value>>
+    span<const value_type> next_contiguous(size_t max_count) {
+        if (!skip_leading()) {
+            return {};
+        }
+        return parent_gen_.next_contiguous(max_count);
+    }
+
+    /**
+     * @return generator over the same parent which behaves as this one followed by SkipGenerator of amount
+     */
+    SkipGenerator skip_more(size_t amount) && {
+        if (skipped_) {
+            return SkipGenerator(std::move(parent_gen_), amount);
+        }
+        size_t total = amount > std::numeric_limits<size_t>::max() - amount_to_skip_
+                       ? std::numeric_limits<size_t>::max() : amount_to_skip_ + amount;
+        return SkipGenerator(std::move(parent_gen_), total);
+    }
+
 private:
+    /**
+     * Skips leading elements on the first call
+     * @return false if parent generator was exhausted while skipping
+     */
+    bool skip_leading() {
+        if (skipped_) {
+            return true;
+        }
+        skipped_ = true;
+        return internal::advance(parent_gen_, amount_to_skip_) == amount_to_skip_;
+    }
+
     ParentGenerator parent_gen_;
     const size_t amount_to_skip_;
     bool skipped_;
@@ -206,6 +930,9 @@ public:
     GetGenerator(const ParentGenerator & parent_gen, size_t amount)
             : parent_gen_(parent_gen), amount_to_get_(amount), amount_got_(0) {}
 
+    GetGenerator(ParentGenerator && parent_gen, size_t amount)
+            : parent_gen_(std::move(parent_gen)), amount_to_get_(amount), amount_got_(0) {}
+
     GetGenerator(const GetGenerator & other) = default;
 
     GetGenerator(GetGenerator && other)
@@ -226,12 +953,94 @@ public:
         return parent_gen_();
     }
 
+    SizeHint size_hint() const {
+        size_t amount_left = amount_to_get_ - std::min(amount_got_, amount_to_get_);
+        SizeHint parent_hint = internal::size_hint_of(parent_gen_);
+        if (!parent_hint.is_known()) {
+            return SizeHint::upper_bound(amount_left);
+        }
+        parent_hint.value = std::min(parent_hint.value, amount_left);
+        return parent_hint;
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        if (amount_got_ >= amount_to_get_) {
+            return false;
+        }
+
+        bool stopped = false;
+        internal::for_each_until(parent_gen_, [&](auto && value) {
+            ++amount_got_;
+            stopped = sink(std::forward<decltype(value)>(value));
+            return stopped || amount_got_ >= amount_to_get_;
+        });
+        return stopped;
+    }
+
+    size_t next_batch(span<value_type> out) {
+        if (amount_got_ >= amount_to_get_) {
+            return 0;
+        }
+
+        size_t got = internal::next_batch(parent_gen_, out.first(std::min(out.size(), amount_to_get_ - amount_got_)));
+        amount_got_ += got;
+        return got;
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<has_next_contiguous<Parent>::value>>
+    span<const value_type> next_contiguous(size_t max_count) {
+        if (amount_got_ >= amount_to_get_) {
+            return {};
+        }
+
+        span<const value_type> block = parent_gen_.next_contiguous(std::min(max_count, amount_to_get_ - amount_got_));
+        amount_got_ += block.size();
+        return block;
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<has_advance<Parent>::value>>
+    size_t advance(size_t amount) {
+        if (amount_got_ >= amount_to_get_) {
+            return 0;
+        }
+
+        size_t skipped = parent_gen_.advance(std::min(amount, amount_to_get_ - amount_got_));
+        amount_got_ += skipped;
+        return skipped;
+    }
+
+    /**
+     * @return generator over the same parent which behaves as this one followed by GetGenerator of amount
+     */
+    GetGenerator get_at_most(size_t amount) && {
+        GetGenerator limited(std::move(parent_gen_), amount_got_ + std::min(amount, amount_to_get_ - amount_got_));
+        limited.amount_got_ = amount_got_;
+        return limited;
+    }
+
 private:
     ParentGenerator parent_gen_;
     const size_t amount_to_get_;
     size_t amount_got_;
 };
 
+/**
+ * Predicate of adjacent filters merged into one: an element is kept if it satisfies both of them
+ */
+template<class First, class Second>
+struct predicate_conjunction {
+    First first;
+    Second second;
+
+    template<class T>
+    bool operator()(T & value) {
+        return first(value) && second(value);
+    }
+};
+
 template<class ParentGenerator, class Predicate>
 class FilterGenerator {
 public:
@@ -245,6 +1054,10 @@ public:
                     Predicate && predicate)
             : parent_gen_(parent_gen), predicate_(std::move(predicate)) {}
 
+    FilterGenerator(ParentGenerator && parent_gen,
+                    Predicate && predicate)
+            : parent_gen_(std::move(parent_gen)), predicate_(std::move(predicate)) {}
+
     FilterGenerator(FilterGenerator && other)
             : parent_gen_(std::move(other.parent_gen_)),
               predicate_(std::move(other.predicate_)) {}
@@ -262,32 +1075,102 @@ public:
         return opt;
     }
 
+    SizeHint size_hint() const {
+        SizeHint parent_hint = internal::size_hint_of(parent_gen_);
+        if (!parent_hint.is_known()) {
+            return parent_hint;
+        }
+        return SizeHint::upper_bound(parent_hint.value);
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        return internal::for_each_until(parent_gen_, [&](auto && value) {
+            return predicate_(value) && sink(std::forward<decltype(value)>(value));
+        });
+    }
+
+    size_t next_batch(span<value_type> out) {
+        size_t got;
+        while ((got = internal::next_batch(parent_gen_, out))) {
+            size_t kept = 0;
+            for (size_t i = 0; i < got; ++i) {
+                if (!predicate_(out[i])) {
+                    continue;
+                }
+                if (kept != i) {
+                    out[kept] = std::move(out[i]);
+                }
+                ++kept;
+            }
+            if (kept) {
+                return kept;
+            }
+        }
+        return 0;
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<is_sliceable<Parent>::value>>
+    size_t slice_extent() const {
+        return parent_gen_.slice_extent();
+    }
+
+    /**
+     * @return FilterGenerator over the slice of parent generator
+     */
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<is_sliceable<Parent>::value>>
+    auto slice(size_t first, size_t count) const {
+        using ParentSlice = decltype(parent_gen_.slice(first, count));
+        return FilterGenerator<ParentSlice, Predicate>(parent_gen_.slice(first, count), Predicate(predicate_));
+    }
+
+
+    /**
+     * @return FilterGenerator over the same parent keeping elements which satisfy this predicate and next one
+     */
+    template<class Next>
+    FilterGenerator<ParentGenerator, predicate_conjunction<Predicate, Next>> and_filter(Next && next) && {
+        using Conjunction = predicate_conjunction<Predicate, Next>;
+        return FilterGenerator<ParentGenerator, Conjunction>(std::move(parent_gen_),
+                                                             Conjunction{std::move(predicate_), std::move(next)});
+    }
 private:
     ParentGenerator parent_gen_;
     Predicate predicate_;
 };
 
-template<class ParentGenerator>
+/**
+ * Groups elements of parent generator into vectors allocated by given allocator
+ */
+template<class ParentGenerator, class Allocator = std::allocator<typename ParentGenerator::value_type>>
 class GroupGenerator {
     using parent_value_type = typename ParentGenerator::value_type;
 public:
-    using value_type = std::vector<parent_value_type>;
+    using value_type = std::vector<parent_value_type, Allocator>;
+
+    GroupGenerator(const ParentGenerator & parent_gen, size_t group_size, const Allocator & allocator = Allocator())
+            : parent_gen_(parent_gen), group_size_(group_size), allocator_(allocator) {}
 
-    GroupGenerator(const ParentGenerator & parent_gen, size_t group_size)
-            : parent_gen_(parent_gen), group_size_(group_size) {}
+    GroupGenerator(ParentGenerator && parent_gen, size_t group_size, const Allocator & allocator = Allocator())
+            : parent_gen_(std::move(parent_gen)), group_size_(group_size), allocator_(allocator) {}
 
     GroupGenerator(const GroupGenerator & other) = default;
 
     GroupGenerator(GroupGenerator && other)
             : parent_gen_(std::move(other.parent_gen_)),
-              group_size_(other.group_size_) {}
+              group_size_(other.group_size_),
+              allocator_(other.allocator_),
+              remaining_hint_(other.remaining_hint_) {}
 
     ~GroupGenerator() = default;
 
     GroupGenerator & operator=(const GroupGenerator & other) = delete;
 
     std::optional<value_type> operator()() {
-        value_type group;
+        value_type group(allocator_);
+        reserve_group(group);
         std::optional<parent_value_type> opt = parent_gen_();
         if (!opt.has_value()) {
             return std::nullopt;
@@ -295,15 +1178,244 @@ public:
 
         size_t i = 0;
         do {
-            group.push_back(opt.value());
+            group.push_back(std::move(opt.value()));
             ++i;
         } while (i < group_size_ && (opt = parent_gen_()));
+        count_taken(i);
+        return group;
+    }
+
+    SizeHint size_hint() const {
+        SizeHint parent_hint = internal::size_hint_of(parent_gen_);
+        size_t group_size = std::max<size_t>(group_size_, 1);
+        parent_hint.value = parent_hint.value / group_size + (parent_hint.value % group_size ? 1 : 0);
+        return parent_hint;
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        value_type group(allocator_);
+        reserve_group(group);
+        bool stopped = internal::for_each_until(parent_gen_, [&](auto && value) {
+            group.push_back(std::forward<decltype(value)>(value));
+            if (group.size() < group_size_) {
+                return false;
+            }
+            count_taken(group.size());
+            bool stop = sink(std::exchange(group, value_type(allocator_)));
+            reserve_group(group);
+            return stop;
+        });
+        if (stopped || group.empty()) {
+            return stopped;
+        }
+        return sink(std::move(group));
+    }
+
+private:
+    /**
+     * Reserves space for the next group, which is never larger than the amount of remaining elements.
+     * Hint of the parent may take linear time, so it is taken once and counted down as groups are taken.
+     */
+    void reserve_group(value_type & group) {
+        if (!remaining_hint_.has_value()) {
+            remaining_hint_ = internal::size_hint_of(parent_gen_);
+        }
+        size_t capacity = std::max<size_t>(group_size_, 1);
+        if (remaining_hint_->is_known()) {
+            capacity = std::min(capacity, remaining_hint_->value);
+        }
+        group.reserve(capacity);
+    }
+
+    void count_taken(size_t amount) {
+        if (remaining_hint_.has_value()) {
+            remaining_hint_->value -= std::min(remaining_hint_->value, amount);
+        }
+    }
+
+    ParentGenerator parent_gen_;
+    const size_t group_size_;
+    Allocator allocator_;
+    // Hint of the parent less elements taken since, unset until the first group
+    std::optional<SizeHint> remaining_hint_;
+};
+
+/**
+ * Groups elements of parent generator into inline vectors of at most GroupSize elements
+ */
+template<class ParentGenerator, size_t GroupSize>
+class FixedGroupGenerator {
+    using parent_value_type = typename ParentGenerator::value_type;
+public:
+    using value_type = inline_vector<parent_value_type, GroupSize>;
+
+    explicit FixedGroupGenerator(const ParentGenerator & parent_gen) : parent_gen_(parent_gen) {}
+
+    explicit FixedGroupGenerator(ParentGenerator && parent_gen) : parent_gen_(std::move(parent_gen)) {}
+
+    FixedGroupGenerator(const FixedGroupGenerator & other) = default;
+
+    FixedGroupGenerator(FixedGroupGenerator && other) = default;
+
+    ~FixedGroupGenerator() = default;
+
+    FixedGroupGenerator & operator=(const FixedGroupGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        std::optional<value_type> group(std::in_place);
+        std::optional<parent_value_type> opt;
+        while (!group->full() && (opt = parent_gen_())) {
+            group->push_back(std::move(opt.value()));
+        }
+        if (group->empty()) {
+            return std::nullopt;
+        }
+        return group;
+    }
+
+    SizeHint size_hint() const {
+        SizeHint parent_hint = internal::size_hint_of(parent_gen_);
+        parent_hint.value = parent_hint.value / GroupSize + (parent_hint.value % GroupSize ? 1 : 0);
+        return parent_hint;
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        value_type group;
+        bool stopped = internal::for_each_until(parent_gen_, [&](auto && value) {
+            group.push_back(std::forward<decltype(value)>(value));
+            if (!group.full()) {
+                return false;
+            }
+            bool stop = sink(group);
+            group.clear();
+            return stop;
+        });
+        if (stopped || group.empty()) {
+            return stopped;
+        }
+        return sink(group);
+    }
+
+private:
+    ParentGenerator parent_gen_;
+};
+
+/**
+ * Groups elements of parent generator into spans, which stay valid until the next group is taken.
+ * Spans point into the parent storage when it is contiguous, otherwise into a buffer reused for every group.
+ */
+template<class ParentGenerator>
+class SpanGroupGenerator {
+    using parent_value_type = typename ParentGenerator::value_type;
+public:
+    using value_type = span<const parent_value_type>;
+
+    SpanGroupGenerator(const ParentGenerator & parent_gen, size_t group_size,
+                       std::pmr::memory_resource * memory_resource = std::pmr::get_default_resource())
+            : parent_gen_(parent_gen), group_size_(std::max<size_t>(group_size, 1)), buffer_(memory_resource) {}
+
+    SpanGroupGenerator(ParentGenerator && parent_gen, size_t group_size,
+                       std::pmr::memory_resource * memory_resource = std::pmr::get_default_resource())
+            : parent_gen_(std::move(parent_gen)), group_size_(std::max<size_t>(group_size, 1)),
+              buffer_(memory_resource) {}
+
+    SpanGroupGenerator(const SpanGroupGenerator & other)
+            : parent_gen_(other.parent_gen_), group_size_(other.group_size_),
+              buffer_(other.buffer_, other.buffer_.get_allocator()) {}
+
+    SpanGroupGenerator(SpanGroupGenerator && other) = default;
+
+    ~SpanGroupGenerator() = default;
+
+    SpanGroupGenerator & operator=(const SpanGroupGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        value_type group = next_group();
+        if (group.empty()) {
+            return std::nullopt;
+        }
         return group;
     }
 
+    SizeHint size_hint() const {
+        SizeHint parent_hint = internal::size_hint_of(parent_gen_);
+        parent_hint.value = parent_hint.value / group_size_ + (parent_hint.value % group_size_ ? 1 : 0);
+        return parent_hint;
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        if constexpr (has_next_contiguous<ParentGenerator>::value) {
+            value_type group;
+            while (!(group = next_group()).empty()) {
+                if (sink(group)) {
+                    return true;
+                }
+            }
+            return false;
+        } else {
+            buffer_.clear();
+            buffer_.reserve(group_size_);
+            bool stopped = internal::for_each_until(parent_gen_, [&](auto && value) {
+                buffer_.push_back(std::forward<decltype(value)>(value));
+                if (buffer_.size() < group_size_) {
+                    return false;
+                }
+                bool stop = sink(value_type(buffer_.data(), buffer_.size()));
+                buffer_.clear();
+                return stop;
+            });
+            if (stopped || buffer_.empty()) {
+                return stopped;
+            }
+            return sink(value_type(buffer_.data(), buffer_.size()));
+        }
+    }
+
 private:
+    value_type next_group() {
+        buffer_.clear();
+        if constexpr (has_next_contiguous<ParentGenerator>::value) {
+            value_type block = parent_gen_.next_contiguous(group_size_);
+            if (block.size() == group_size_ || block.empty()) {
+                return block;
+            }
+            // Parent storage ended in the middle of the group, the rest has to be gathered into the buffer
+            buffer_.reserve(group_size_);
+            do {
+                buffer_.insert(buffer_.end(), block.begin(), block.end());
+            } while (buffer_.size() < group_size_ &&
+                     !(block = parent_gen_.next_contiguous(group_size_ - buffer_.size())).empty());
+        } else {
+            buffer_.reserve(group_size_);
+            std::optional<parent_value_type> opt;
+            while (buffer_.size() < group_size_ && (opt = parent_gen_())) {
+                buffer_.push_back(std::move(opt.value()));
+            }
+        }
+        return value_type(buffer_.data(), buffer_.size());
+    }
+
     ParentGenerator parent_gen_;
     const size_t group_size_;
+    std::pmr::vector<parent_value_type> buffer_;
+};
+
+/**
+ * Transform of adjacent maps merged into one. Result of the first one is materialized as a value,
+ * exactly as the first map would yield it.
+ */
+template<class First, class Second>
+struct composed_transform {
+    First first;
+    Second second;
+
+    template<class T>
+    auto operator()(T && value) -> std::invoke_result_t<Second &, std::invoke_result_t<First &, T>> {
+        return second(first(std::forward<T>(value)));
+    }
 };
 
 template<class ParentGenerator, class Transform>
@@ -313,18 +1425,26 @@ public:
     using value_type = std::invoke_result_t<Transform, parent_value_type>;
 
     MapGenerator(const ParentGenerator & parent_gen,
-                 const Transform & transform)
-            : parent_gen_(parent_gen), transform_(transform) {}
+                 const Transform & transform,
+                 std::pmr::memory_resource * memory_resource = std::pmr::get_default_resource())
+            : parent_gen_(parent_gen), transform_(transform), memory_resource_(memory_resource) {}
 
     MapGenerator(const ParentGenerator & parent_gen,
-                 Transform && transform)
-            : parent_gen_(parent_gen), transform_(std::move(transform)) {}
+                 Transform && transform,
+                 std::pmr::memory_resource * memory_resource = std::pmr::get_default_resource())
+            : parent_gen_(parent_gen), transform_(std::move(transform)), memory_resource_(memory_resource) {}
 
-    MapGenerator(MapGenerator && other)
-            : parent_gen_(std::move(other.parent_gen_)),
-              transform_(std::move(other.transform_)) {}
+    MapGenerator(ParentGenerator && parent_gen,
+                 Transform && transform,
+                 std::pmr::memory_resource * memory_resource = std::pmr::get_default_resource())
+            : parent_gen_(std::move(parent_gen)), transform_(std::move(transform)), memory_resource_(memory_resource) {}
 
-    MapGenerator(const MapGenerator & other) = default;
+    MapGenerator(MapGenerator && other) = default;
+
+    MapGenerator(const MapGenerator & other)
+            : parent_gen_(other.parent_gen_),
+              transform_(other.transform_),
+              memory_resource_(other.memory_resource_) {}
 
     ~MapGenerator() = default;
 
@@ -336,14 +1456,250 @@ public:
             return std::nullopt;
         }
 
-        return transform_(opt.value());
+        return transform_(std::move(opt.value()));
     }
 
+    SizeHint size_hint() const {
+        return internal::size_hint_of(parent_gen_);
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        return internal::for_each_until(parent_gen_, [&](auto && value) {
+            return sink(transform_(std::forward<decltype(value)>(value)));
+        });
+    }
+
+    template<class T = parent_value_type,
+            typename = std::enable_if_t<std::is_default_constructible<T>::value &&
+                                        !std::is_same<T, bool>::value>>
+    size_t next_batch(span<value_type> out) {
+        if (!batch_buffer_) {
+            batch_buffer_ = std::make_unique<std::pmr::vector<parent_value_type>>(memory_resource_);
+        }
+        if (batch_buffer_->size() < out.size()) {
+            batch_buffer_->resize(out.size());
+        }
+        size_t got = internal::next_batch(parent_gen_, span<parent_value_type>(batch_buffer_->data(), out.size()));
+        for (size_t i = 0; i < got; ++i) {
+            out[i] = transform_(std::move((*batch_buffer_)[i]));
+        }
+        return got;
+    }
+
+    /**
+     * Skips elements of random access parent without transforming them
+     */
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<has_advance<Parent>::value>>
+    size_t advance(size_t amount) {
+        return parent_gen_.advance(amount);
+    }
+
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<is_sliceable<Parent>::value>>
+    size_t slice_extent() const {
+        return parent_gen_.slice_extent();
+    }
+
+    /**
+     * @return MapGenerator over the slice of parent generator. Slices are processed on worker threads,
+     * so they allocate from the default resource rather than from the one of this generator.
+     */
+    template<class Parent = ParentGenerator,
+            typename = std::enable_if_t<is_sliceable<Parent>::value>>
+    auto slice(size_t first, size_t count) const {
+        using ParentSlice = decltype(parent_gen_.slice(first, count));
+        return MapGenerator<ParentSlice, Transform>(parent_gen_.slice(first, count), Transform(transform_));
+    }
+
+
+    /**
+     * @return MapGenerator over the same parent applying this transform and then next one
+     */
+    template<class Next>
+    MapGenerator<ParentGenerator, composed_transform<Transform, Next>>
+    and_map(Next && next, std::pmr::memory_resource * memory_resource) && {
+        using Composed = composed_transform<Transform, Next>;
+        return MapGenerator<ParentGenerator, Composed>(std::move(parent_gen_),
+                                                       Composed{std::move(transform_), std::move(next)},
+                                                       memory_resource);
+    }
 private:
     ParentGenerator parent_gen_;
     Transform transform_;
+    std::pmr::memory_resource * memory_resource_;
+    // Parent elements of a batch, allocated by the first next_batch only
+    std::unique_ptr<std::pmr::vector<parent_value_type>> batch_buffer_;
+};
+
+/**
+ * Transforms elements of parent generator on a thread pool, keeping up to window elements in flight,
+ * and yields results in order of parent elements. Parent generator is pulled on the consumer thread only.
+ * Copies do not share elements in flight: a copy starts from the state of parent generator being copied.
+ */
+template<class ParentGenerator, class Transform>
+class ParallelMapGenerator {
+    using parent_value_type = typename ParentGenerator::value_type;
+public:
+    using value_type = std::invoke_result_t<Transform, parent_value_type>;
+
+    ParallelMapGenerator(const ParentGenerator & parent_gen,
+                         const Transform & transform,
+                         size_t threads, size_t window)
+            : parent_gen_(parent_gen), transform_(std::make_shared<Transform>(transform)),
+              threads_(std::max<size_t>(threads, 1)), window_(std::max<size_t>(window, 1)) {}
+
+    ParallelMapGenerator(ParentGenerator && parent_gen,
+                         Transform && transform,
+                         size_t threads, size_t window)
+            : parent_gen_(std::move(parent_gen)), transform_(std::make_shared<Transform>(std::move(transform))),
+              threads_(std::max<size_t>(threads, 1)), window_(std::max<size_t>(window, 1)) {}
+
+    ParallelMapGenerator(const ParallelMapGenerator & other)
+            : parent_gen_(other.parent_gen_), transform_(std::make_shared<Transform>(*other.transform_)),
+              threads_(other.threads_), window_(other.window_), exhausted_(other.exhausted_) {}
+
+    ParallelMapGenerator(ParallelMapGenerator && other) = default;
+
+    ~ParallelMapGenerator() = default;
+
+    ParallelMapGenerator & operator=(const ParallelMapGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        fill_window();
+        if (in_flight_.empty()) {
+            return std::nullopt;
+        }
+
+        std::future<value_type> next = std::move(in_flight_.front());
+        in_flight_.pop_front();
+        fill_window();
+        return next.get();
+    }
+
+    SizeHint size_hint() const {
+        SizeHint parent_hint = internal::size_hint_of(parent_gen_);
+        if (parent_hint.is_known()) {
+            parent_hint.value += in_flight_.size();
+        }
+        return parent_hint;
+    }
+
+private:
+    void fill_window() {
+        while (!exhausted_ && in_flight_.size() < window_) {
+            std::optional<parent_value_type> opt = parent_gen_();
+            if (!opt.has_value()) {
+                exhausted_ = true;
+                break;
+            }
+            if (!pool_) {
+                pool_ = std::make_unique<WorkStealingPool>(threads_);
+            }
+            in_flight_.push_back(pool_->submit(
+                    [transform = transform_, value = std::move(opt.value())]() mutable {
+                        return (*transform)(std::move(value));
+                    }));
+        }
+    }
+
+    ParentGenerator parent_gen_;
+    // Shared with tasks in flight, so that they stay valid when generator is moved
+    std::shared_ptr<Transform> transform_;
+    size_t threads_;
+    size_t window_;
+    bool exhausted_ = false;
+    std::deque<std::future<value_type>> in_flight_;
+    // Declared last to be destroyed first, waiting for tasks in flight
+    std::unique_ptr<WorkStealingPool> pool_;
+};
+
+/**
+ * Stage appended to a stream by skip. Adjacent skips are merged into one skipping their total amount.
+ */
+template<class Generator>
+struct skip_stage {
+    using type = SkipGenerator<Generator>;
+
+    static type make(Generator && gen, size_t amount) {
+        return type(std::move(gen), amount);
+    }
+};
+
+template<class Parent>
+struct skip_stage<SkipGenerator<Parent>> {
+    using type = SkipGenerator<Parent>;
+
+    static type make(SkipGenerator<Parent> && gen, size_t amount) {
+        return std::move(gen).skip_more(amount);
+    }
+};
+
+/**
+ * Stage appended to a stream by get. Adjacent gets are merged into one getting the least amount.
+ */
+template<class Generator>
+struct get_stage {
+    using type = GetGenerator<Generator>;
+
+    static type make(Generator && gen, size_t amount) {
+        return type(std::move(gen), amount);
+    }
+};
+
+template<class Parent>
+struct get_stage<GetGenerator<Parent>> {
+    using type = GetGenerator<Parent>;
+
+    static type make(GetGenerator<Parent> && gen, size_t amount) {
+        return std::move(gen).get_at_most(amount);
+    }
+};
+
+/**
+ * Stage appended to a stream by filter. Adjacent filters are merged into one checking their conjunction.
+ */
+template<class Generator, class Predicate>
+struct filter_stage {
+    using type = FilterGenerator<Generator, Predicate>;
+
+    static type make(Generator && gen, Predicate && predicate) {
+        return type(std::move(gen), std::move(predicate));
+    }
+};
+
+template<class Parent, class First, class Predicate>
+struct filter_stage<FilterGenerator<Parent, First>, Predicate> {
+    using type = FilterGenerator<Parent, predicate_conjunction<First, Predicate>>;
+
+    static type make(FilterGenerator<Parent, First> && gen, Predicate && predicate) {
+        return std::move(gen).and_filter(std::move(predicate));
+    }
+};
+
+/**
+ * Stage appended to a stream by map. Adjacent maps are merged into one applying their composition.
+ */
+template<class Generator, class Transform>
+struct map_stage {
+    using type = MapGenerator<Generator, Transform>;
+
+    static type make(Generator && gen, Transform && transform, std::pmr::memory_resource * memory_resource) {
+        return type(std::move(gen), std::move(transform), memory_resource);
+    }
+};
+
+template<class Parent, class First, class Transform>
+struct map_stage<MapGenerator<Parent, First>, Transform> {
+    using type = MapGenerator<Parent, composed_transform<First, Transform>>;
+
+    static type make(MapGenerator<Parent, First> && gen, Transform && transform,
+                     std::pmr::memory_resource * memory_resource) {
+        return std::move(gen).and_map(std::move(transform), memory_resource);
+    }
 };
 
 }
 
-#endif //STREAM_UTILS_H
+#endif //STREAM_UTILS_H
\ No newline at end of file
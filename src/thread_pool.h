@@ -0,0 +1,164 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cppstream::internal {
+
+/**
+ * Fixed-size thread pool. Every worker owns a task queue, takes tasks from its back and steals tasks
+ * from the front of other queues when its own one is empty.
+ * Destructor waits for all submitted tasks to complete.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads)
+            : queues_(std::max<size_t>(threads, 1)) {
+        workers_.reserve(queues_.size());
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            workers_.emplace_back([this, i]() { run(i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool & other) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread & worker : workers_) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool & operator=(const WorkStealingPool & other) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * Schedules task for execution
+     * @return future receiving result or exception of the task
+     */
+    template<class Task>
+    std::future<std::invoke_result_t<Task>> submit(Task && task) {
+        using result_type = std::invoke_result_t<Task>;
+        auto packaged = std::make_shared<std::packaged_task<result_type()>>(std::forward<Task>(task));
+        std::future<result_type> result = packaged->get_future();
+
+        TaskQueue & queue = queues_[next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size()];
+        // Counted before it is published, so that a worker taking it at once never brings pending_ below zero
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            ++pending_;
+        }
+        try {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back([packaged]() { (*packaged)(); });
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            --pending_;
+            throw;
+        }
+        wake_.notify_one();
+        return result;
+    }
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool pop_task(size_t index, std::function<void()> & task) {
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            TaskQueue & queue = queues_[(index + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            if (i == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            --pending_;
+            return true;
+        }
+        return false;
+    }
+
+    void run(size_t index) {
+        std::function<void()> task;
+        for (;;) {
+            if (pop_task(index, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait(lock, [this]() { return stopping_ || pending_ > 0; });
+            if (stopping_ && pending_ == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<TaskQueue> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<size_t> pending_{0};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+/**
+ * Splits [0, extent) into contiguous chunks and calls chunk_function(first, count) for each of them on a pool
+ * of given amount of threads. Chunks are smaller than extent / threads, so that idle workers can steal them.
+ * @return results of chunk_function in order of chunks
+ */
+template<class ChunkFunction>
+std::vector<std::invoke_result_t<ChunkFunction &, size_t, size_t>>
+parallel_chunks(size_t threads, size_t extent, ChunkFunction && chunk_function) {
+    using result_type = std::invoke_result_t<ChunkFunction &, size_t, size_t>;
+    constexpr size_t chunks_per_thread = 4;
+    size_t chunk_count = std::max<size_t>(std::min(extent, threads * chunks_per_thread), 1);
+    size_t chunk_size = extent / chunk_count;
+    size_t larger_chunks = extent % chunk_count;
+
+    std::vector<std::future<result_type>> futures;
+    futures.reserve(chunk_count);
+    std::vector<result_type> results;
+    results.reserve(chunk_count);
+    {
+        WorkStealingPool pool(threads);
+        size_t first = 0;
+        for (size_t i = 0; i < chunk_count; ++i) {
+            size_t count = chunk_size + (i < larger_chunks ? 1 : 0);
+            futures.push_back(pool.submit([&chunk_function, first, count]() {
+                return chunk_function(first, count);
+            }));
+            first += count;
+        }
+    }
+    for (std::future<result_type> & future : futures) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+}
+
+#endif //THREAD_POOL_H
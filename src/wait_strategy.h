@@ -0,0 +1,167 @@
+#ifndef WAIT_STRATEGY_H
+#define WAIT_STRATEGY_H
+
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) && __has_include(<linux/futex.h>) && __has_include(<sys/syscall.h>)
+#define CPPSTREAM_FUTEX 1
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace cppstream::internal {
+
+constexpr size_t cache_line_size = 64;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * Checks ready() while spinning and then yielding the processor
+ * @return true if ready() returned true within the given amount of checks
+ */
+template<class Ready>
+bool spin_until(Ready & ready, size_t spin_count, size_t yield_count) {
+    for (size_t i = 0; i < spin_count + yield_count; ++i) {
+        if (ready()) {
+            return true;
+        }
+        if (i < spin_count) {
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return false;
+}
+
+}
+
+namespace cppstream {
+
+/**
+ * Wait strategies let threads wait until a condition published by other threads holds.
+ * A strategy object is shared by the waiting threads and the notifying ones:
+ * wait_until(ready) blocks until ready() returns true, and notify() must follow every store making it true.
+ */
+
+/**
+ * Waits by spinning and yielding the processor only. Has the least latency, but keeps a core busy
+ * for every waiting thread. Notifying costs nothing.
+ */
+class spin_wait {
+public:
+    template<class Ready>
+    void wait_until(Ready && ready) {
+        while (!internal::spin_until(ready, spin_count, 1)) {
+        }
+    }
+
+    void notify() {}
+
+private:
+    static constexpr size_t spin_count = 64;
+};
+
+/**
+ * Spins for a while, then sleeps on a condition variable. Notifying costs a fence,
+ * unless some thread actually sleeps.
+ */
+class park_wait {
+public:
+    template<class Ready>
+    void wait_until(Ready && ready) {
+        if (internal::spin_until(ready, spin_count, yield_count)) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        // The increment pairs with the fence of notify(): either the notifier sees a sleeper,
+        // or ready() sees its stores
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        condition_.wait(lock, ready);
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            condition_.notify_all();
+        }
+    }
+
+private:
+    static constexpr size_t spin_count = 64;
+    static constexpr size_t yield_count = 16;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::atomic<size_t> sleepers_{0};
+};
+
+#ifdef CPPSTREAM_FUTEX
+
+/**
+ * Spins for a while, then sleeps on a futex (Linux only). Unlike park_wait, neither side takes a lock:
+ * notifying bumps a counter and wakes its sleepers with one system call, only if there are any.
+ */
+class futex_wait {
+public:
+    template<class Ready>
+    void wait_until(Ready && ready) {
+        if (internal::spin_until(ready, spin_count, yield_count)) {
+            return;
+        }
+        while (true) {
+            uint32_t epoch = epoch_.load(std::memory_order_acquire);
+            // Pairs with the fence of notify() like in park_wait. A notify() after the epoch was read
+            // changes it, so that the futex does not sleep.
+            sleepers_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ready()) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            if (ready()) {
+                return;
+            }
+        }
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) > 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex word must be a plain 32-bit integer.");
+
+    static constexpr size_t spin_count = 64;
+    static constexpr size_t yield_count = 16;
+
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> sleepers_{0};
+};
+
+#endif
+
+}
+
+#endif //WAIT_STRATEGY_H
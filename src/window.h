@@ -0,0 +1,405 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <deque>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "stream_utils.h"
+
+namespace cppstream::internal {
+
+/**
+ * Type in which window sums are kept: 64-bit integers for integral elements, so that sums of windows
+ * of e.g. int do not overflow long before their elements or their mean would
+ */
+template<class T>
+using window_sum_t = std::conditional_t<std::is_integral<T>::value,
+        std::conditional_t<std::is_signed<T>::value, long long, unsigned long long>, T>;
+
+}
+
+namespace cppstream {
+
+/**
+ * Aggregates of windows are computed incrementally: every element entering a window is pushed
+ * to the state of the aggregate, and every element leaving it is popped, so that each element costs O(1)
+ * however large the window is.
+ */
+
+/**
+ * Sum of window elements, kept by adding entering elements and subtracting leaving ones.
+ * Sums of integral elements are long long (unsigned long long for unsigned elements) and exact.
+ * Floating-point sums collect rounding errors of all elements which ever passed the window, so that after
+ * large elements left it, the sum of small remaining ones may keep an error of the order of the large ones.
+ */
+struct moving_sum {
+    template<class T>
+    class state {
+    public:
+        explicit state(const moving_sum & unused) {}
+
+        void push(const T & value) { sum_ += value; }
+
+        void pop(const T & value) { sum_ -= value; }
+
+        internal::window_sum_t<T> value() const { return sum_; }
+
+    private:
+        internal::window_sum_t<T> sum_ = internal::window_sum_t<T>();
+    };
+};
+
+/**
+ * Arithmetic mean of window elements, as double unless elements are of a floating-point type.
+ * Computed from a sum kept like the one of moving_sum, exact for integral elements
+ * and drifting with rounding errors for floating-point ones.
+ */
+struct moving_mean {
+    template<class T>
+    class state {
+    public:
+        using result_type = std::conditional_t<std::is_floating_point<T>::value, T, double>;
+
+        explicit state(const moving_mean & unused) {}
+
+        void push(const T & value) {
+            sum_ += value;
+            ++count_;
+        }
+
+        void pop(const T & value) {
+            sum_ -= value;
+            --count_;
+        }
+
+        result_type value() const { return static_cast<result_type>(sum_) / static_cast<result_type>(count_); }
+
+    private:
+        internal::window_sum_t<T> sum_ = internal::window_sum_t<T>();
+        size_t count_ = 0;
+    };
+};
+
+/**
+ * Least window element by Compare, kept in a monotonic deque of elements which can still become the least one.
+ * Every element enters and leaves the deque at most once.
+ */
+template<class Compare = std::less<>>
+struct moving_min {
+    Compare compare;
+
+    explicit moving_min(Compare compare = Compare()) : compare(std::move(compare)) {}
+
+    template<class T>
+    class state {
+    public:
+        explicit state(const moving_min & props) : compare_(props.compare) {}
+
+        void push(const T & value) {
+            while (!candidates_.empty() && compare_(value, candidates_.back().second)) {
+                candidates_.pop_back();
+            }
+            candidates_.emplace_back(pushed_++, value);
+        }
+
+        void pop(const T & unused) {
+            if (candidates_.front().first == popped_++) {
+                candidates_.pop_front();
+            }
+        }
+
+        T value() const { return candidates_.front().second; }
+
+    private:
+        Compare compare_;
+        // Elements not preceded by a lesser later element, paired with their positions
+        std::deque<std::pair<size_t, T>> candidates_;
+        size_t pushed_ = 0;
+        size_t popped_ = 0;
+    };
+};
+
+/**
+ * Greatest window element by Compare
+ */
+template<class Compare = std::less<>>
+struct moving_max {
+    Compare compare;
+
+    explicit moving_max(Compare compare = Compare()) : compare(std::move(compare)) {}
+
+    template<class T>
+    class state {
+    public:
+        explicit state(const moving_max & props) : min_state_(moving_min<Reversed>(Reversed{props.compare})) {}
+
+        void push(const T & value) { min_state_.push(value); }
+
+        void pop(const T & value) { min_state_.pop(value); }
+
+        T value() const { return min_state_.value(); }
+
+    private:
+        struct Reversed {
+            Compare compare;
+
+            bool operator()(const T & lhs, const T & rhs) { return compare(rhs, lhs); }
+        };
+
+        typename moving_min<Reversed>::template state<T> min_state_;
+    };
+};
+
+/**
+ * Window elements combined by an associative operation in their order, e.g. a product or a string concatenation.
+ * Kept as a queue of two stacks: entering elements are folded into the back one, and leaving elements
+ * are taken from the front one, which stores folds of its suffixes and is refilled from the back one when empty.
+ */
+template<class Operation>
+struct moving_reduce {
+    Operation operation;
+
+    explicit moving_reduce(Operation operation) : operation(std::move(operation)) {}
+
+    template<class T>
+    class state {
+    public:
+        explicit state(const moving_reduce & props) : operation_(props.operation) {}
+
+        void push(const T & value) {
+            back_fold_ = back_.empty() ? value : operation_(std::move(*back_fold_), value);
+            back_.push_back(value);
+        }
+
+        void pop(const T & unused) {
+            if (front_folds_.empty()) {
+                // Folds of the moved elements, from the newest one to the oldest, so that the top is the oldest
+                for (auto it = back_.rbegin(); it != back_.rend(); ++it) {
+                    front_folds_.push_back(front_folds_.empty() ? *it : operation_(*it, front_folds_.back()));
+                }
+                back_.clear();
+                back_fold_.reset();
+            }
+            front_folds_.pop_back();
+        }
+
+        T value() const {
+            if (front_folds_.empty()) {
+                return *back_fold_;
+            }
+            if (back_.empty()) {
+                return front_folds_.back();
+            }
+            return operation_(front_folds_.back(), *back_fold_);
+        }
+
+    private:
+        mutable Operation operation_;
+        std::vector<T> front_folds_;
+        std::vector<T> back_;
+        std::optional<T> back_fold_;
+    };
+};
+
+}
+
+namespace cppstream::internal {
+
+/**
+ * Amount of windows of given size taken every step elements out of amount elements
+ */
+inline size_t window_count(size_t amount, size_t size, size_t step) {
+    return amount < size ? 0 : (amount - size) / step + 1;
+}
+
+inline SizeHint window_size_hint(SizeHint parent_hint, size_t size, size_t step) {
+    if (parent_hint.is_known()) {
+        parent_hint.value = window_count(parent_hint.value, size, step);
+    }
+    return parent_hint;
+}
+
+/**
+ * Yields windows of size consecutive elements starting every step elements, as spans into a buffer
+ * reused for every window, which stay valid until the next window is taken. Only complete windows are yielded.
+ * Buffer holds at most twice the window size, so that each element is moved within it O(1) times on average.
+ */
+template<class ParentGenerator>
+class WindowGenerator {
+    using parent_value_type = typename ParentGenerator::value_type;
+public:
+    using value_type = span<const parent_value_type>;
+
+    WindowGenerator(ParentGenerator && parent_gen, size_t size, size_t step,
+                    std::pmr::memory_resource * memory_resource = std::pmr::get_default_resource())
+            : parent_gen_(std::move(parent_gen)), size_(std::max<size_t>(size, 1)), step_(std::max<size_t>(step, 1)),
+              buffer_(memory_resource) {}
+
+    WindowGenerator(const WindowGenerator & other)
+            : parent_gen_(other.parent_gen_), size_(other.size_), step_(other.step_),
+              buffer_(other.buffer_, other.buffer_.get_allocator()), begin_(other.begin_),
+              to_skip_(other.to_skip_), slide_pending_(other.slide_pending_) {}
+
+    WindowGenerator(WindowGenerator && other) = default;
+
+    ~WindowGenerator() = default;
+
+    WindowGenerator & operator=(const WindowGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        std::optional<parent_value_type> opt;
+        while ((opt = parent_gen_())) {
+            if (add(std::move(opt.value()))) {
+                return current_window();
+            }
+        }
+        return std::nullopt;
+    }
+
+    SizeHint size_hint() const {
+        return window_size_hint(internal::size_hint_of(parent_gen_), size_, step_);
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        return internal::for_each_until(parent_gen_, [&](auto && value) {
+            return add(std::forward<decltype(value)>(value)) && sink(current_window());
+        });
+    }
+
+private:
+    /**
+     * @return true if value completes a window
+     */
+    template<class V>
+    bool add(V && value) {
+        if (slide_pending_) {
+            slide_pending_ = false;
+            if (step_ >= size_) {
+                buffer_.clear();
+                begin_ = 0;
+                to_skip_ = step_ - size_;
+            } else {
+                begin_ += step_;
+            }
+        }
+        if (to_skip_ > 0) {
+            --to_skip_;
+            return false;
+        }
+        if (begin_ >= size_) {
+            buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(begin_));
+            begin_ = 0;
+        }
+        buffer_.push_back(std::forward<V>(value));
+        if (buffer_.size() - begin_ < size_) {
+            return false;
+        }
+        slide_pending_ = true;
+        return true;
+    }
+
+    value_type current_window() const {
+        return value_type(buffer_.data() + begin_, size_);
+    }
+
+    ParentGenerator parent_gen_;
+    const size_t size_;
+    const size_t step_;
+    std::pmr::vector<parent_value_type> buffer_;
+    // Position of the current window in the buffer
+    size_t begin_ = 0;
+    // Elements between windows when step exceeds size
+    size_t to_skip_ = 0;
+    // The window was yielded, and is moved forward when the next element comes
+    bool slide_pending_ = false;
+};
+
+/**
+ * Yields aggregates of windows of size consecutive elements starting every step elements.
+ * Last size elements are kept in a ring, from which the aggregate learns which element leaves the window.
+ * Only complete windows are aggregated.
+ */
+template<class ParentGenerator, class Aggregate>
+class WindowAggregateGenerator {
+    using parent_value_type = typename ParentGenerator::value_type;
+    using State = typename Aggregate::template state<parent_value_type>;
+public:
+    using value_type = std::decay_t<decltype(std::declval<const State &>().value())>;
+
+    WindowAggregateGenerator(ParentGenerator && parent_gen, size_t size, size_t step, const Aggregate & aggregate)
+            : parent_gen_(std::move(parent_gen)), size_(std::max<size_t>(size, 1)), step_(std::max<size_t>(step, 1)),
+              state_(aggregate), until_window_(size_) {
+        ring_.reserve(size_);
+    }
+
+    WindowAggregateGenerator(const WindowAggregateGenerator & other) = default;
+
+    WindowAggregateGenerator(WindowAggregateGenerator && other) = default;
+
+    ~WindowAggregateGenerator() = default;
+
+    WindowAggregateGenerator & operator=(const WindowAggregateGenerator & other) = delete;
+
+    std::optional<value_type> operator()() {
+        std::optional<parent_value_type> opt;
+        while ((opt = parent_gen_())) {
+            if (add(std::move(opt.value()))) {
+                return state_.value();
+            }
+        }
+        return std::nullopt;
+    }
+
+    SizeHint size_hint() const {
+        return window_size_hint(internal::size_hint_of(parent_gen_), size_, step_);
+    }
+
+    template<class Sink>
+    bool for_each_until(Sink && sink) {
+        return internal::for_each_until(parent_gen_, [&](auto && value) {
+            return add(std::forward<decltype(value)>(value)) && sink(state_.value());
+        });
+    }
+
+private:
+    /**
+     * @return true if value completes a window
+     */
+    template<class V>
+    bool add(V && value) {
+        if (ring_.size() < size_) {
+            ring_.push_back(std::forward<V>(value));
+            state_.push(ring_.back());
+        } else {
+            state_.pop(ring_[oldest_]);
+            ring_[oldest_] = std::forward<V>(value);
+            state_.push(ring_[oldest_]);
+            if (++oldest_ == size_) {
+                oldest_ = 0;
+            }
+        }
+        if (--until_window_ > 0) {
+            return false;
+        }
+        until_window_ = step_;
+        return true;
+    }
+
+    ParentGenerator parent_gen_;
+    const size_t size_;
+    const size_t step_;
+    State state_;
+    std::vector<parent_value_type> ring_;
+    size_t oldest_ = 0;
+    // Elements left to take before the next window is complete
+    size_t until_window_;
+};
+
+}
+
+#endif //WINDOW_H
@@ -2,12 +2,109 @@
 
 #include "../src/stream.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <memory_resource>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
+#include <unistd.h>
 
 namespace {
 
 using namespace cppstream;
 
+struct CopyCountingVector : std::vector<int> {
+    static size_t copies;
+
+    using std::vector<int>::vector;
+
+    CopyCountingVector(const CopyCountingVector & other) : std::vector<int>(other) { ++copies; }
+
+    CopyCountingVector(CopyCountingVector && other) = default;
+};
+
+size_t CopyCountingVector::copies = 0;
+
+struct CopyCountingString {
+    static size_t copies;
+
+    std::string text;
+
+    explicit CopyCountingString(std::string text) : text(std::move(text)) {}
+
+    CopyCountingString(const CopyCountingString & other) : text(other.text) { ++copies; }
+
+    CopyCountingString(CopyCountingString && other) = default;
+
+    CopyCountingString & operator=(const CopyCountingString & other) {
+        text = other.text;
+        ++copies;
+        return *this;
+    }
+
+    CopyCountingString & operator=(CopyCountingString && other) = default;
+};
+
+size_t CopyCountingString::copies = 0;
+
+/**
+ * Sums even elements pushed to a channel by several producers, taking them by groups
+ */
+template<class WaitStrategy>
+long sum_from_producers(size_t producers, int per_producer) {
+    channel<int, WaitStrategy> events(64);
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&events, per_producer]() {
+            for (int i = 1; i <= per_producer; ++i) {
+                events.push(i);
+            }
+        });
+    }
+    std::thread closer([&]() {
+        for (std::thread & thread : threads) {
+            thread.join();
+        }
+        events.close();
+    });
+
+    long total = Stream(events)
+                 | filter([](int i) { return i % 2 == 0; })
+                 | map([](int i) { return static_cast<long>(i); })
+                 | group(3)
+                 | map([](const std::vector<long> & group) { return std::accumulate(group.begin(), group.end(), 0L); })
+                 | sum();
+    closer.join();
+    return total;
+}
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+
+private:
+    void * do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void * ptr, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+        return this == &other;
+    }
+};
+
 TEST(StreamConstruction, Infinite) {
     Stream s([](){ return 1;});
 
@@ -42,6 +139,26 @@ TEST(StreamConstruction, ContainerMove) {
     EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5}), s | to_vector());
 }
 
+TEST(StreamConstruction, View) {
+    std::vector<int> container({1, 2, 3, 4, 5});
+
+    Stream s(view(container));
+    container[0] = 10;
+
+    EXPECT_EQ(std::vector<int>({10, 2, 3, 4, 5}), s | to_vector());
+    EXPECT_TRUE((std::is_same<Stream<internal::ViewGenerator<const int *>, StreamTag::Finite>, decltype(s)>::value));
+}
+
+TEST(StreamConstruction, ViewOfNonContiguousContainer) {
+    const std::list<int> container({1, 2, 3, 4, 5});
+
+    Stream s(view(container.begin(), container.end()));
+    Stream s2(view(container));
+
+    EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5}), s | to_vector());
+    EXPECT_EQ(15, s2 | sum());
+}
+
 TEST(StreamConstruction, Pack) {
     Stream s(1, 2, 3, 4, 5);
 
@@ -62,6 +179,89 @@ TEST(StreamConstruction, Move) {
     EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5}), s2 | to_vector());
 }
 
+TEST(StreamConstruction, RvalueChainDoesNotCopySource) {
+    CopyCountingVector::copies = 0;
+
+    auto vec = Stream(CopyCountingVector({1, 2, 3, 4, 5, 6}))
+               | skip(1)
+               | filter([](int val) { return val % 2; })
+               | map([](int val) { return val * 10; })
+               | get(2)
+               | to_vector();
+
+    EXPECT_EQ(std::vector<int>({30, 50}), vec);
+    EXPECT_EQ(0u, CopyCountingVector::copies);
+    EXPECT_EQ(std::vector<int>({2, 3}), Stream(1, 2, 3) | skip(1) | to_vector());
+}
+
+TEST(StreamConstruction, LvalueChainKeepsSource) {
+    CopyCountingVector::copies = 0;
+    Stream s(CopyCountingVector({1, 2, 3}));
+
+    auto mapped = s | map([](int val) { return val + 1; });
+
+    EXPECT_EQ(1u, CopyCountingVector::copies);
+    EXPECT_EQ(std::vector<int>({2, 3, 4}), mapped | to_vector());
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), s | to_vector());
+    EXPECT_EQ(6, s | sum());
+}
+
+TEST(StreamConstruction, MappedFile) {
+    struct Record {
+        int32_t id;
+        float value;
+    };
+    std::vector<Record> records;
+    for (int32_t i = 0; i < 1000; ++i) {
+        records.push_back({i, 0.5f * static_cast<float>(i)});
+    }
+    std::string path = ::testing::TempDir() + "cpp_stream_mapped_file.bin";
+    std::FILE * file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+    std::fwrite(records.data(), sizeof(Record), records.size(), file);
+    std::fclose(file);
+
+    auto s = from_mmap<Record>(path);
+    auto ids = s | map([](const Record & record) { return record.id; });
+    auto tail = ids | skip(995) | to_vector();
+    Record middle = s | nth(500);
+
+    EXPECT_EQ(SizeHint::exact(1000), s.size_hint());
+    EXPECT_EQ(std::vector<int32_t>({995, 996, 997, 998, 999}), tail);
+    EXPECT_EQ(500, middle.id);
+    EXPECT_FLOAT_EQ(250.0f, middle.value);
+    EXPECT_EQ(499500, ids | sum());
+    EXPECT_EQ(499500, ids | par(2) | sum());
+    EXPECT_EQ(std::vector<int32_t>({10, 11}), ids | skip(10) | get(2) | to_vector());
+    std::remove(path.c_str());
+    EXPECT_THROW(from_mmap<Record>(path), std::system_error);
+}
+
+TEST(StreamConstruction, LinesOfIstream) {
+    std::istringstream input("first\nsecond line\n\na rather long third line\nlast");
+    std::vector<std::string> read;
+
+    Stream s(lines(input, '\n', 4));
+    s | for_each([&read](std::string_view line) { read.emplace_back(line); });
+
+    EXPECT_EQ(std::vector<std::string>({"first", "second line", "", "a rather long third line", "last"}), read);
+    EXPECT_TRUE(s.is_finite());
+}
+
+TEST(StreamConstruction, LinesOfFd) {
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    std::string data = "1,22,333,";
+    ASSERT_EQ(static_cast<ssize_t>(data.size()), ::write(fds[1], data.data(), data.size()));
+    ::close(fds[1]);
+
+    Stream s(lines(fds[0], ','));
+    auto lengths = s | map([](std::string_view field) { return field.size(); }) | to_vector();
+    ::close(fds[0]);
+
+    EXPECT_EQ(std::vector<size_t>({1, 2, 3}), lengths);
+}
+
 TEST(StreamInfo, IsFinite) {
     const std::vector<int> container({1, 2, 3, 4, 5});
 
@@ -78,6 +278,34 @@ TEST(StreamInfo, IsFinite) {
     EXPECT_TRUE(cont_move.is_finite());
 }
 
+TEST(StreamInfo, SizeHint) {
+    Stream s{1, 2, 3, 4, 5};
+    auto is_odd = [](int val) { return val % 2; };
+
+    EXPECT_EQ(SizeHint::exact(5), s.size_hint());
+    EXPECT_EQ(SizeHint::exact(5), Stream(1, 2, 3, 4, 5).size_hint());
+    EXPECT_EQ(SizeHint::exact(3), (s | skip(2)).size_hint());
+    EXPECT_EQ(SizeHint::exact(0), (s | skip(7)).size_hint());
+    EXPECT_EQ(SizeHint::exact(2), (s | get(2) | map([](int val) { return val * 2; })).size_hint());
+    EXPECT_EQ(SizeHint::upper_bound(5), (s | filter(is_odd)).size_hint());
+    EXPECT_EQ(SizeHint::upper_bound(2), (s | filter(is_odd) | skip(3)).size_hint());
+    EXPECT_EQ(SizeHint::exact(2), (s | group(3)).size_hint());
+    EXPECT_EQ(SizeHint::unknown(), Stream([]() { return 1; }).size_hint());
+    EXPECT_EQ(SizeHint::upper_bound(4), (Stream([]() { return 1; }) | get(4)).size_hint());
+}
+
+TEST(StreamInfo, SizeHintReservesResult) {
+    std::vector<int> values(1000, 3);
+
+    auto vec = Stream(view(values)) | to_vector();
+    auto groups = Stream(view(values)) | group(300) | to_vector();
+
+    EXPECT_EQ(1000u, vec.capacity());
+    ASSERT_EQ(4u, groups.size());
+    EXPECT_EQ(300u, groups[0].capacity());
+    EXPECT_EQ(100u, groups[3].capacity());
+}
+
 TEST(StreamTerminalOpsTest, Nth) {
     Stream s{1, 2, 3, 4, 5};
 
@@ -107,6 +335,75 @@ TEST(StreamTerminalOpsTest, Sum) {
     EXPECT_EQ(15, stream_sum);
 }
 
+TEST(StreamTerminalOpsTest, SumVectorized) {
+    std::vector<int64_t> values(1003);
+    std::vector<int8_t> bytes(777);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int64_t>(i * i) - 5000;
+    }
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<int8_t>(i * 7);
+    }
+    int64_t expected = 0;
+    int64_t expected_odd = 0;
+    int8_t expected_bytes = 0;
+    for (int64_t val : values) {
+        expected += val;
+        expected_odd += (val % 2) ? 3 * val : 0;
+    }
+    for (int8_t val : bytes) {
+        expected_bytes += val;
+    }
+
+    EXPECT_EQ(expected, Stream(view(values)) | sum());
+    EXPECT_EQ(expected, Stream(values) | sum());
+    EXPECT_EQ(expected - values[0], Stream(view(values)) | skip(1) | sum());
+    EXPECT_EQ(expected_odd, Stream(view(values))
+                            | filter([](int64_t val) { return val % 2; })
+                            | map([](int64_t val) { return 3 * val; })
+                            | sum());
+    EXPECT_EQ(expected_bytes, Stream(view(bytes)) | sum());
+}
+
+TEST(StreamTerminalOpsTest, SumFloatingPointOrder) {
+    std::vector<double> values(1001);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    double expected = 0.0;
+    for (double val : values) {
+        expected += val;
+    }
+
+    EXPECT_EQ(expected, Stream(view(values)) | sum());
+    EXPECT_EQ(expected, Stream(view(values)) | sum(SummationOrder::Sequential));
+    EXPECT_NEAR(expected, Stream(view(values)) | sum(SummationOrder::Any), 1e-12);
+}
+
+TEST(StreamTerminalOpsTest, MinMax) {
+    std::vector<int> values(1000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int>((i * 7919) % 1000) - 300;
+    }
+
+    EXPECT_EQ(-300, Stream(view(values)) | min());
+    EXPECT_EQ(699, Stream(view(values)) | max());
+    EXPECT_EQ(-299, Stream(view(values)) | filter([](int val) { return val % 2; }) | min());
+    EXPECT_DOUBLE_EQ(-2.5, Stream(1.5, -2.5, 3.0) | min());
+    EXPECT_EQ(std::string("pear"), Stream(std::vector<std::string>({"apple", "pear", "fig"})) | max());
+    EXPECT_THROW(Stream(std::vector<int>()) | min(), IllegalStreamOperation);
+}
+
+TEST(StreamTerminalOpsTest, Count) {
+    std::vector<int> values(1000, 1);
+
+    EXPECT_EQ(1000u, Stream(view(values)) | count());
+    EXPECT_EQ(998u, Stream(values) | skip(2) | count());
+    EXPECT_EQ(4u, Stream(1, 2, 3, 4, 5, 6, 7) | group(2) | count());
+    EXPECT_EQ(3u, Stream(1, 2, 3, 4, 5, 6, 7) | filter([](int val) { return val % 2 == 0; }) | count());
+    EXPECT_EQ(0u, Stream(std::vector<int>()) | count());
+}
+
 TEST(StreamTerminalOpsTest, Reduce) {
     Stream s{1, 2, 3, 4, 5};
 
@@ -121,6 +418,149 @@ TEST(StreamTerminalOpsTest, Reduce) {
     EXPECT_DOUBLE_EQ(38.0, complex_result);
 }
 
+TEST(StreamTerminalOpsTest, WriteTo) {
+    std::ostringstream os;
+    Stream ints{1, -20, 300};
+    Stream doubles{0.1, 2.5, 1e300};
+    Stream strings(std::vector<std::string>({"a", "bc"}));
+
+    ints | write_to(os);
+    os << '|';
+    doubles | write_to(os, ", ");
+    os << '|';
+    strings | write_to(os, "\n");
+    Stream(std::vector<int>()) | write_to(os);
+
+    EXPECT_EQ("1 -20 300|0.1, 2.5, 1e+300|a\nbc", os.str());
+}
+
+TEST(StreamTerminalOpsTest, WriteToFileAndFd) {
+    std::FILE * file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+    char read[64] = {};
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    std::vector<long> longs{7, 8, 9};
+
+    Stream(view(longs)) | write_to(file, ",");
+    std::rewind(file);
+    std::fread(read, 1, sizeof(read) - 1, file);
+    std::fclose(file);
+    EXPECT_STREQ("7,8,9", read);
+
+    Stream(std::vector<char>({'o', 'k'})) | write_to(fds[1], "");
+    ::close(fds[1]);
+    EXPECT_EQ(2, ::read(fds[0], read, sizeof(read)));
+    ::close(fds[0]);
+    EXPECT_EQ("ok", std::string(read, 2));
+}
+
+TEST(StreamTerminalOpsTest, WriteBinary) {
+    std::string path = ::testing::TempDir() + "cpp_stream_binary.bin";
+    std::vector<int64_t> values(1000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int64_t>(i * i);
+    }
+    auto squares = Stream(view(values));
+    struct Residues {
+        int32_t by_seven;
+        int32_t by_eleven;
+    };
+    auto residues = squares | map([](int64_t val) {
+        return Residues{static_cast<int32_t>(val % 7), static_cast<int32_t>(val % 11)};
+    });
+
+    EXPECT_EQ(1000u, squares | write_binary(path, 64));
+    auto read = from_binary<int64_t>(path);
+    EXPECT_EQ(SizeHint::exact(1000), read.size_hint());
+    EXPECT_EQ(values, read | to_vector());
+    EXPECT_THROW(from_binary<int32_t>(path), std::runtime_error);
+
+    EXPECT_EQ(1000u, residues | write_binary(path, 100));
+    Residues last = from_binary<Residues>(path) | nth(999);
+    EXPECT_EQ(999 * 999 % 7, last.by_seven);
+    EXPECT_EQ(999 * 999 % 11, last.by_eleven);
+
+    EXPECT_EQ(0u, squares | get(0) | write_binary(path));
+    EXPECT_EQ(0u, from_binary<int64_t>(path) | count());
+
+    // Count whose size in bytes wraps around to the size of one record
+    squares | get(1) | write_binary(path);
+    std::FILE * file = std::fopen(path.c_str(), "r+b");
+    ASSERT_NE(nullptr, file);
+    uint64_t hostile_count = (uint64_t(1) << 61) + 1;
+    std::fseek(file, offsetof(internal::BinaryHeader, count), SEEK_SET);
+    std::fwrite(&hostile_count, sizeof(hostile_count), 1, file);
+    std::fclose(file);
+    EXPECT_THROW(from_binary<int64_t>(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(StreamTerminalOpsTest, ReduceDeduced) {
+    Stream s{1, 2, 3, 4, 5};
+    auto accumulate = [](double res, int val) { return res + 2.0 * val; };
+    auto combine = [](double lhs, double rhs) { return lhs + rhs; };
+    auto simple = reduce(accumulate);
+    auto with_identity = reduce([](int val) { return 10.0 * val; }, accumulate);
+    auto with_combiner = reduce([](int val) { return 2.0 * val; }, accumulate, combine);
+
+    EXPECT_TRUE((std::is_same<decltype(accumulate), decltype(simple.accumulator)>::value));
+    EXPECT_TRUE((std::is_same<double, decltype(s | std::move(simple))>::value));
+    EXPECT_DOUBLE_EQ(29.0, s | reduce(accumulate));
+    EXPECT_DOUBLE_EQ(38.0, s | std::move(with_identity));
+    EXPECT_DOUBLE_EQ(30.0, s | par(2) | std::move(with_combiner));
+    EXPECT_EQ(std::string("abc"), Stream(std::vector<char>({'a', 'b', 'c'}))
+                                  | reduce([](char c) { return std::string(1, c); },
+                                           [](std::string res, char c) { return res + c; }));
+}
+
+TEST(StreamTerminalOpsTest, ReduceMutableFunctors) {
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 1);
+    Stream s(view(values));
+    auto counting_sum = [calls = 0](int lhs, int rhs) mutable {
+        ++calls;
+        return lhs + rhs;
+    };
+    auto tagged = [first = true](int val) mutable {
+        bool was_first = std::exchange(first, false);
+        return was_first ? 0L + val : 0L;
+    };
+    auto add = [calls = 0](long lhs, int rhs) mutable {
+        ++calls;
+        return lhs + rhs;
+    };
+    auto combine = [calls = 0](long lhs, long rhs) mutable {
+        ++calls;
+        return lhs + rhs;
+    };
+
+    EXPECT_EQ(500500, s | reduce(counting_sum));
+    EXPECT_EQ(500500L, s | reduce(tagged, add));
+    EXPECT_EQ(500500L, s | par(4) | reduce(tagged, add, combine));
+}
+
+TEST(StreamTerminalOpsTest, ShortCircuit) {
+    int next = 0;
+    Stream naturals([&next]() { return next++; });
+    Stream s{1, 2, 3, 4, 5};
+    auto is_even = [](int val) { return val % 2 == 0; };
+    auto above_ten = [](int val) { return val > 10; };
+    std::vector<int> visited;
+
+    EXPECT_TRUE(naturals | any_of(above_ten));
+    EXPECT_EQ(12, next);
+    EXPECT_EQ(std::optional<int>(2), s | find_first(is_even));
+    EXPECT_EQ(std::nullopt, s | find_first(above_ten));
+    EXPECT_FALSE(s | any_of(above_ten));
+    EXPECT_FALSE(s | all_of(is_even));
+    EXPECT_TRUE(s | map([](int val) { return 2 * val; }) | all_of(is_even));
+    EXPECT_EQ(2u, s | count(is_even));
+    EXPECT_EQ(5u, s | count());
+    s | for_each([&visited](int val) { visited.push_back(val); });
+    EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5}), visited);
+}
+
 TEST(StreamTerminalOpsTest, ToVector) {
     Stream s{1, 2, 3, 4, 5};
 
@@ -139,6 +579,41 @@ TEST(StreamNonTerminalOpsTest, Skip) {
     EXPECT_TRUE(skipped.is_finite());
 }
 
+TEST(StreamNonTerminalOpsTest, SkipRandomAccess) {
+    std::vector<int> values(100000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int>(i);
+    }
+    size_t transformed = 0;
+    auto page = Stream(view(values))
+                | map([&transformed](int val) {
+                    ++transformed;
+                    return val * 2;
+                })
+                | skip(90000)
+                | get(3)
+                | to_vector();
+
+    EXPECT_EQ(std::vector<int>({180000, 180002, 180004}), page);
+    EXPECT_EQ(3u, transformed);
+    EXPECT_EQ(99999, Stream(values) | skip(50000) | nth(49999));
+    EXPECT_EQ(std::vector<int>({4, 5}), Stream(1, 2, 3, 4, 5) | skip(3) | to_vector());
+    EXPECT_EQ(std::vector<int>(), Stream(1, 2, 3, 4, 5) | skip(6) | to_vector());
+    EXPECT_TRUE(internal::has_advance<internal::GetGenerator<internal::ViewGenerator<const int *>>>::value);
+    EXPECT_FALSE(internal::has_advance<internal::ContainerGenerator<std::list<int>>>::value);
+}
+
+TEST(StreamNonTerminalOpsTest, SkipSequentialAccess) {
+    const std::list<int> values({1, 2, 3, 4, 5});
+    auto is_odd = [](int val) { return val % 2; };
+
+    EXPECT_EQ(std::vector<int>({4, 5}), Stream(values) | skip(3) | to_vector());
+    EXPECT_EQ(std::vector<int>({5}), Stream(values) | filter(is_odd) | skip(2) | to_vector());
+    EXPECT_EQ(5, Stream(values) | filter(is_odd) | nth(2));
+    EXPECT_THROW(Stream(values) | filter(is_odd) | nth(3), IllegalStreamOperation);
+    EXPECT_THROW(Stream(view(values)) | skip(2) | nth(3), IllegalStreamOperation);
+}
+
 TEST(StreamNonTerminalOpsTest, Get) {
     Stream s{1, 2, 3, 4, 5};
 
@@ -170,6 +645,52 @@ TEST(StreamNonTerminalOpsTest, Group) {
     EXPECT_TRUE(grouped_stream.is_finite());
 }
 
+TEST(StreamNonTerminalOpsTest, GroupOfListSource) {
+    // Hint of a list takes linear time, and is taken only once rather than for every group
+    Stream pairs(std::list<int>(200000, 1));
+    EXPECT_EQ(100000u, pairs | group(2) | count());
+
+    Stream s(std::list<int>({1, 2, 3, 4, 5}));
+    auto groups = s | group(4) | to_vector();
+    ASSERT_EQ(2u, groups.size());
+    EXPECT_EQ(std::vector<int>({5}), groups[1]);
+    EXPECT_EQ(1u, groups[1].capacity());
+    auto pulled = s | group(4) | get(2) | to_vector();
+    EXPECT_EQ(groups, pulled);
+    EXPECT_EQ(1u, pulled[1].capacity());
+}
+
+TEST(StreamNonTerminalOpsTest, GroupFixedSize) {
+    Stream s{1, 2, 3, 4, 5};
+
+    auto grouped_stream = s | group<2>();
+    auto vec = grouped_stream | to_vector();
+
+    EXPECT_TRUE((std::is_same<inline_vector<int, 2>, decltype(grouped_stream)::value_type>::value));
+    EXPECT_EQ((std::vector<inline_vector<int, 2>>({{1, 2}, {3, 4}, {5}})), vec);
+    EXPECT_EQ(SizeHint::exact(3), grouped_stream.size_hint());
+    EXPECT_EQ((inline_vector<int, 2>{3, 4}), grouped_stream | nth(1));
+    EXPECT_EQ(3u, grouped_stream | count());
+}
+
+TEST(StreamNonTerminalOpsTest, GroupReusedBuffer) {
+    std::vector<int> vec{1, 2, 3, 4, 5};
+    std::list<int> lst(vec.begin(), vec.end());
+    auto to_vectors = [](auto && stream) {
+        std::vector<std::vector<int>> groups;
+        stream | for_each([&groups](span<const int> group) { groups.emplace_back(group.begin(), group.end()); });
+        return groups;
+    };
+    auto over_vector = Stream(view(vec)) | group(2, reuse_buffer);
+    auto over_list = Stream(view(lst)) | group(2, reuse_buffer);
+    std::vector<std::vector<int>> expected{{1, 2}, {3, 4}, {5}};
+
+    EXPECT_EQ(expected, to_vectors(over_vector));
+    EXPECT_EQ(expected, to_vectors(over_list));
+    EXPECT_EQ(vec.data() + 2, (over_vector | nth(1)).data());
+    EXPECT_EQ(3u, over_list | count());
+}
+
 TEST(StreamNonTerminalOpsTest, Map) {
     Stream s{1, 2, 3};
 
@@ -180,4 +701,707 @@ TEST(StreamNonTerminalOpsTest, Map) {
     EXPECT_TRUE(mapped_stream.is_finite());
 }
 
+TEST(StreamPushIterationTest, StopsInfiniteSource) {
+    int next = 0;
+    Stream s([&next]() { return next++; });
+
+    auto vec = s | filter([](int val) { return val % 3 == 0; })
+               | map([](int val) { return val / 3; })
+               | get(4)
+               | to_vector();
+
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), vec);
+    EXPECT_EQ(10, next);
+}
+
+TEST(StreamPushIterationTest, ContinuesAfterPull) {
+    Stream s{1, 2, 3, 4, 5, 6, 7};
+
+    EXPECT_EQ(18, s | skip(2) | get(4) | sum());
+    EXPECT_EQ(std::vector<std::vector<int>>({{3, 4}, {5, 6}, {7}}), s | skip(2) | group(2) | to_vector());
+    EXPECT_EQ(6, s | skip(1) | nth(4));
+}
+
+struct PullOnlyGenerator {
+    using value_type = int;
+
+    int current = 0;
+
+    std::optional<int> operator()() {
+        if (current == 3) return std::nullopt;
+        return current++;
+    }
+};
+
+TEST(StreamPushIterationTest, FallsBackToPull) {
+    PullOnlyGenerator gen;
+    std::vector<int> pushed;
+
+    bool stopped = internal::for_each_until(gen, [&](int val) {
+        pushed.push_back(val);
+        return false;
+    });
+
+    EXPECT_FALSE(internal::has_for_each_until<PullOnlyGenerator>::value);
+    EXPECT_TRUE(internal::has_for_each_until<internal::ContainerGenerator<std::vector<int>>>::value);
+    EXPECT_FALSE(stopped);
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), pushed);
+}
+
+TEST(StreamBatchTest, TransformsBlocks) {
+    using Source = internal::ContainerGenerator<std::vector<int>>;
+    auto is_odd = [](int val) { return val % 2 == 1; };
+    auto twice = [](int val) { return 2 * val; };
+    using Filtered = internal::FilterGenerator<internal::SkipGenerator<Source>, decltype(is_odd)>;
+    internal::MapGenerator<Filtered, decltype(twice)> gen(
+            Filtered(internal::SkipGenerator<Source>(Source(std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9})), 1),
+                     is_odd),
+            twice);
+    int buffer[3];
+    span<int> out(buffer, 3);
+
+    EXPECT_TRUE(internal::has_next_batch<decltype(gen)>::value);
+    ASSERT_EQ(1u, gen.next_batch(out));
+    EXPECT_EQ(6, buffer[0]);
+    ASSERT_EQ(2u, gen.next_batch(out));
+    EXPECT_EQ(10, buffer[0]);
+    EXPECT_EQ(14, buffer[1]);
+    ASSERT_EQ(1u, gen.next_batch(out));
+    EXPECT_EQ(18, buffer[0]);
+    EXPECT_EQ(0u, gen.next_batch(out));
+}
+
+TEST(StreamBatchTest, MovesElementsIntoTransform) {
+    using Source = internal::ContainerGenerator<std::vector<std::unique_ptr<int>>>;
+    std::vector<std::unique_ptr<int>> values;
+    for (int i = 1; i <= 3; ++i) {
+        values.push_back(std::make_unique<int>(i));
+    }
+    auto unwrap = [](std::unique_ptr<int> && ptr) { return *ptr; };
+    internal::MapGenerator<Source, decltype(unwrap)> gen(Source(std::move(values)), std::move(unwrap));
+    int buffer[2];
+
+    ASSERT_EQ(2u, gen.next_batch(span<int>(buffer, 2)));
+    EXPECT_EQ(2, buffer[1]);
+    ASSERT_EQ(1u, gen.next_batch(span<int>(buffer, 2)));
+    EXPECT_EQ(3, buffer[0]);
+}
+
+TEST(StreamBatchTest, LimitsAndFallsBack) {
+    int next = 0;
+    auto counter = [&next]() { return next++; };
+    internal::GetGenerator<internal::InfiniteGenerator<decltype(counter)>> got(
+            internal::InfiniteGenerator<decltype(counter)>(std::move(counter)), 5);
+    PullOnlyGenerator pull_only;
+    int buffer[4];
+
+    EXPECT_EQ(4u, internal::next_batch(got, span<int>(buffer, 4)));
+    EXPECT_EQ(1u, internal::next_batch(got, span<int>(buffer, 4)));
+    EXPECT_EQ(4, buffer[0]);
+    EXPECT_EQ(0u, internal::next_batch(got, span<int>(buffer, 4)));
+    EXPECT_EQ(5, next);
+
+    EXPECT_EQ(3u, internal::next_batch(pull_only, span<int>(buffer, 4)));
+    EXPECT_EQ(2, buffer[2]);
+}
+
+TEST(StreamParallelTest, SumAndReduce) {
+    std::vector<int64_t> values(100003);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int64_t>(i % 1000) - 400;
+    }
+    auto is_odd = [](int64_t val) { return val % 2 != 0; };
+    auto square = [](int64_t val) { return val * val; };
+    int64_t expected = Stream(view(values)) | filter(is_odd) | map(square) | sum();
+
+    EXPECT_EQ(expected, Stream(view(values)) | par(4) | filter(is_odd) | map(square) | sum());
+    auto reduced = Stream(values) | filter(is_odd) | par(3) | map(square)
+                   | reduce<int64_t, int64_t>([](int64_t val) { return val; },
+                                              [](int64_t acc, int64_t val) { return acc + val; },
+                                              [](int64_t lhs, int64_t rhs) { return lhs + rhs; });
+    EXPECT_EQ(expected, reduced);
+    EXPECT_EQ(1, Stream(1, 2, 3) | par(8) | filter([](int val) { return val < 2; }) | sum());
+    EXPECT_THROW(Stream(view(values)) | par(4) | filter([](int64_t) { return false; }) | sum(),
+                 IllegalStreamOperation);
+}
+
+TEST(StreamParallelTest, ToVectorKeepsOrder) {
+    std::vector<int> values(50000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int>(i);
+    }
+    auto is_odd = [](int val) { return val % 2; };
+    auto twice = [](int val) { return 2 * val; };
+
+    auto sequential = Stream(view(values)) | filter(is_odd) | map(twice) | to_vector();
+    auto parallel = Stream(view(values)) | par(4) | filter(is_odd) | map(twice) | to_vector();
+    auto paged = Stream(view(values)) | par(4) | skip(10) | map(twice) | get(3) | to_vector();
+
+    EXPECT_EQ(sequential, parallel);
+    EXPECT_EQ(std::vector<int>({20, 22, 24}), paged);
+}
+
+TEST(StreamParallelTest, PropagatesExceptions) {
+    std::vector<int> values(10000, 1);
+    values[7777] = 0;
+
+    auto checked_inverse = [](int val) {
+        if (val == 0) {
+            throw std::domain_error("zero");
+        }
+        return 1 / val;
+    };
+
+    EXPECT_THROW(Stream(view(values)) | par(4) | map(checked_inverse) | to_vector(), std::domain_error);
+}
+
+TEST(StreamParallelTest, ParallelMapKeepsOrder) {
+    auto slow_square = [](int val) {
+        std::this_thread::sleep_for(std::chrono::microseconds((val * 37) % 50));
+        return val * val;
+    };
+
+    auto squares = Stream(1, 2, 3, 4, 5, 6, 7, 8, 9, 10) | par_map(slow_square, 4, 3) | to_vector();
+    auto grouped = Stream{1, 2, 3, 4, 5}
+                   | par_map(slow_square, 2)
+                   | filter([](int val) { return val % 2; })
+                   | group(2)
+                   | to_vector();
+
+    EXPECT_EQ(std::vector<int>({1, 4, 9, 16, 25, 36, 49, 64, 81, 100}), squares);
+    EXPECT_EQ(std::vector<std::vector<int>>({{1, 9}, {25}}), grouped);
+}
+
+TEST(StreamParallelTest, ParallelMapOnInfiniteStream) {
+    int next = 0;
+    Stream s([&next]() { return next++; });
+
+    auto vec = s | par_map([](int val) { return val * 10; }, 3, 4) | get(5) | to_vector();
+
+    EXPECT_EQ(std::vector<int>({0, 10, 20, 30, 40}), vec);
+    EXPECT_LE(next, 5 + 4);
+}
+
+TEST(StreamParallelTest, ParallelMapPropagatesExceptions) {
+    auto checked_inverse = [](int val) {
+        if (val == 0) {
+            throw std::domain_error("zero");
+        }
+        return 1 / val;
+    };
+
+    EXPECT_THROW(Stream(1, 1, 0, 1) | par_map(checked_inverse, 2) | to_vector(), std::domain_error);
+}
+
+TEST(StreamAllocatorTest, ToVector) {
+    CountingResource resource;
+    Stream s{1, 2, 3, 4, 5};
+
+    std::pmr::vector<int> vec = s | to_vector(&resource);
+    std::pmr::vector<int> par_vec = s | par(2) | to_vector(&resource);
+    std::vector<int, std::allocator<int>> rebound = s | to_vector(std::allocator<long>());
+
+    EXPECT_EQ(&resource, vec.get_allocator().resource());
+    EXPECT_EQ(&resource, par_vec.get_allocator().resource());
+    EXPECT_EQ(2u, resource.allocations);
+    EXPECT_TRUE(std::equal(vec.begin(), vec.end(), rebound.begin(), rebound.end()));
+    EXPECT_TRUE(std::equal(vec.begin(), vec.end(), par_vec.begin(), par_vec.end()));
+}
+
+TEST(StreamAllocatorTest, Group) {
+    CountingResource resource;
+    Stream s{1, 2, 3, 4, 5};
+
+    auto groups = s | group(2, &resource) | to_vector();
+
+    EXPECT_TRUE((std::is_same<std::pmr::vector<int>, decltype(groups)::value_type>::value));
+    EXPECT_EQ(3u, groups.size());
+    EXPECT_EQ(&resource, groups[2].get_allocator().resource());
+    EXPECT_EQ(3u, resource.allocations);
+    EXPECT_EQ(std::pmr::vector<int>({3, 4}), groups[1]);
+}
+
+TEST(StreamAllocatorTest, OwnedSourceStaysInResource) {
+    CountingResource resource;
+    std::pmr::vector<int> source({1, 2, 3}, &resource);
+    Stream s(std::move(source));
+    size_t before_copy = resource.allocations;
+
+    auto mapped = s | map([](int val) { return val * 2; });
+
+    EXPECT_EQ(before_copy + 1, resource.allocations);
+    EXPECT_EQ(std::vector<int>({2, 4, 6}), mapped | to_vector());
+}
+
+TEST(StreamAllocatorTest, StreamResource) {
+    CountingResource resource;
+    std::list<int> lst{1, 2, 3, 4, 5};
+    size_t total = 0;
+
+    Stream(view(lst)) | use_resource(&resource) | group(2, reuse_buffer)
+    | for_each([&total](span<const int> group) { total += group.size(); });
+
+    EXPECT_EQ(5u, total);
+    EXPECT_EQ(1u, resource.allocations);
+}
+
+TEST(StreamProfileTest, CountsAndTimesStages) {
+    pipeline_profile report;
+    std::vector<int> vec{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+    auto s = Stream(view(vec)) | profile<true>("source", report)
+             | filter([](int val) { return val % 2 == 0; }) | profile<true>("filter", report)
+             | map([](int val) { return val * val; }) | profile<true>("map", report);
+    int total = s | sum();
+    std::optional<int> pulled = s | find_first([](int val) { return val > 10; });
+    std::ostringstream os;
+    report.print(os);
+
+    EXPECT_EQ(220, total);
+    EXPECT_EQ(std::optional<int>(16), pulled);
+    ASSERT_EQ(3u, report.stages().size());
+    EXPECT_EQ("filter", report.stages()[1].name);
+    EXPECT_EQ(10u + 4u, report.stages()[0].emitted);
+    EXPECT_EQ(5u + 2u, report.stages()[1].emitted);
+    EXPECT_EQ(5u + 2u, report.stages()[2].emitted);
+    EXPECT_LE(report.stages()[0].time, report.stages()[1].time);
+    EXPECT_NE(std::string::npos, os.str().find("filter"));
+    EXPECT_NE(std::string::npos, os.str().find("0.500"));
+}
+
+TEST(StreamProfileTest, DisabledProbeCompilesToNothing) {
+    pipeline_profile report;
+    Stream s{1, 2, 3};
+
+    auto profiled = s | profile<false>("source", report);
+
+    EXPECT_TRUE((std::is_same<decltype(s), decltype(profiled)>::value));
+    EXPECT_EQ(6, profiled | sum());
+    EXPECT_TRUE(report.stages().empty());
+}
+
+TEST(StreamMoveTest, MoveOnlyElements) {
+    std::vector<std::unique_ptr<int>> pointers;
+    for (int i = 1; i <= 6; ++i) {
+        pointers.push_back(std::make_unique<int>(i));
+    }
+
+    auto groups = Stream(std::move(pointers))
+                  | filter([](const std::unique_ptr<int> & ptr) { return *ptr % 2 == 0; })
+                  | map([](std::unique_ptr<int> ptr) { *ptr *= 10; return ptr; })
+                  | group(2)
+                  | to_vector();
+
+    ASSERT_EQ(2, groups.size());
+    EXPECT_EQ(20, *groups[0][0]);
+    EXPECT_EQ(40, *groups[0][1]);
+    EXPECT_EQ(60, *groups[1][0]);
+}
+
+TEST(StreamMoveTest, MoveOnlyPack) {
+    auto values = Stream(std::make_unique<int>(1), std::make_unique<int>(2), std::make_unique<int>(3))
+                  | map([](std::unique_ptr<int> ptr) { return *ptr; })
+                  | to_vector();
+
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), values);
+}
+
+TEST(StreamMoveTest, OwnedSourceIsNotCopied) {
+    std::vector<CopyCountingString> words;
+    for (const char * word : {"move", "not", "copy"}) {
+        words.emplace_back(word);
+    }
+    CopyCountingString::copies = 0;
+
+    auto joined = Stream(std::move(words))
+                  | filter([](const CopyCountingString & word) { return !word.text.empty(); })
+                  | reduce([](CopyCountingString word) { return std::move(word.text); },
+                           [](std::string text, CopyCountingString word) { return std::move(text) + ' ' + word.text; });
+
+    EXPECT_EQ("move not copy", joined);
+    EXPECT_EQ(0, CopyCountingString::copies);
+
+    std::vector<CopyCountingString> pulled;
+    pulled.emplace_back("pulled");
+    auto moved = Stream(std::move(pulled))
+                 | map([](CopyCountingString word) { return word; })
+                 | to_vector();
+
+    EXPECT_EQ("pulled", moved[0].text);
+    EXPECT_EQ(0, CopyCountingString::copies);
+}
+
+TEST(StreamMoveTest, CopiedStreamKeepsItsElements) {
+    Stream s(CopyCountingString("a"), CopyCountingString("b"));
+    auto text = [](const CopyCountingString & word) { return word.text; };
+
+    EXPECT_EQ(std::vector<std::string>({"a", "b"}), s | map(text) | to_vector());
+    EXPECT_EQ(std::vector<std::string>({"a", "b"}), s | map(text) | to_vector());
+
+    Stream v(std::vector<std::string>{"x", "y"});
+    auto rest = v | skip(1);
+
+    EXPECT_EQ(std::vector<std::string>({"y"}), std::move(rest) | to_vector());
+    EXPECT_EQ(std::vector<std::string>({"x", "y"}), v | to_vector());
+}
+
+TEST(StreamFusionTest, MergesAdjacentMaps) {
+    Stream s(std::vector<int>{1, 2, 3});
+    auto twice = [](int i) { return i * 2; };
+    auto text = [](int i) { return std::to_string(i); };
+
+    auto mapped = s | map(twice) | map(text);
+
+    using Source = internal::ContainerGenerator<std::vector<int>>;
+    using Fused = internal::MapGenerator<Source, internal::composed_transform<decltype(twice), decltype(text)>>;
+    EXPECT_TRUE((std::is_same<Stream<Fused, StreamTag::Finite>, decltype(mapped)>::value));
+    EXPECT_EQ(std::vector<std::string>({"2", "4", "6"}), mapped | to_vector());
+    EXPECT_EQ(std::vector<std::string>({"4", "6"}), mapped | skip(1) | to_vector());
+}
+
+TEST(StreamFusionTest, MergesAdjacentFilters) {
+    Stream s(std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+    std::vector<int> checked;
+    auto even = [&checked](int i) { checked.push_back(i); return i % 2 == 0; };
+    auto by_three = [](int i) { return i % 3 == 0; };
+
+    auto filtered = s | filter(even) | filter(by_three);
+
+    using Source = internal::ContainerGenerator<std::vector<int>>;
+    using Fused = internal::FilterGenerator<Source, internal::predicate_conjunction<decltype(even), decltype(by_three)>>;
+    EXPECT_TRUE((std::is_same<Stream<Fused, StreamTag::Finite>, decltype(filtered)>::value));
+    EXPECT_EQ(std::vector<int>({6, 12}), filtered | to_vector());
+    EXPECT_EQ(12, checked.size());
+    EXPECT_EQ(SizeHint::upper_bound(12), filtered.size_hint());
+}
+
+TEST(StreamFusionTest, MergesAdjacentSkipsAndGets) {
+    Stream s(std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8});
+
+    EXPECT_TRUE((std::is_same<decltype(s | skip(3)), decltype(s | skip(1) | skip(2))>::value));
+    EXPECT_TRUE((std::is_same<decltype(s | get(3)), decltype(s | get(5) | get(3))>::value));
+
+    EXPECT_EQ(std::vector<int>({4, 5, 6, 7, 8}), s | skip(1) | skip(2) | to_vector());
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), s | get(5) | get(3) | to_vector());
+    EXPECT_EQ(std::vector<int>({1, 2}), s | get(2) | get(6) | to_vector());
+    EXPECT_EQ(SizeHint::exact(2), (s | get(2) | get(6)).size_hint());
+    EXPECT_TRUE((s | skip(std::numeric_limits<size_t>::max()) | skip(2) | to_vector()).empty());
+    EXPECT_EQ(std::vector<int>({3, 4}), s | skip(1) | skip(1) | get(4) | get(2) | to_vector());
+
+    Stream infinite([i = 0]() mutable { return i++; });
+    EXPECT_EQ(std::vector<int>({5, 6}), infinite | skip(2) | skip(3) | get(10) | get(2) | to_vector());
+}
+
+TEST(StreamAsyncBufferTest, OverlapsProducerAndConsumer) {
+    std::vector<int> vec(10000);
+    std::iota(vec.begin(), vec.end(), 0);
+    std::thread::id consumer = std::this_thread::get_id();
+    std::atomic<bool> produced_elsewhere{true};
+
+    auto result = Stream(vec)
+                  | map([&](int i) {
+                      if (std::this_thread::get_id() == consumer) {
+                          produced_elsewhere = false;
+                      }
+                      return i * 2;
+                  })
+                  | async_buffer(16)
+                  | filter([](int i) { return i % 3 == 0; })
+                  | to_vector();
+
+    std::vector<int> expected;
+    for (int i : vec) {
+        if (i * 2 % 3 == 0) {
+            expected.push_back(i * 2);
+        }
+    }
+    EXPECT_EQ(expected, result);
+    EXPECT_TRUE(produced_elsewhere);
+    EXPECT_EQ(SizeHint::exact(3), (Stream(1, 2, 3) | async_buffer()).size_hint());
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), Stream(1, 2, 3) | async_buffer(1) | to_vector());
+    EXPECT_TRUE((Stream(std::vector<int>()) | async_buffer() | to_vector()).empty());
+}
+
+TEST(StreamAsyncBufferTest, PropagatesExceptionsAfterElements) {
+    std::vector<int> taken;
+    Stream s([i = 0]() mutable {
+        if (i == 5) {
+            throw std::runtime_error("source failed");
+        }
+        return i++;
+    });
+
+    auto record = [&taken](int i) { taken.push_back(i); return false; };
+
+    EXPECT_THROW(s | async_buffer(2) | any_of(record), std::runtime_error);
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), taken);
+}
+
+TEST(StreamAsyncBufferTest, StopsInfiniteProducer) {
+    Stream s([i = 0]() mutable { return i++; });
+
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), s | async_buffer(4) | get(3) | to_vector());
+    EXPECT_EQ(std::vector<int>({10, 11}), s | async_buffer() | skip(10) | get(2) | to_vector());
+
+    std::vector<std::unique_ptr<int>> pointers;
+    pointers.push_back(std::make_unique<int>(7));
+    auto moved = Stream(std::move(pointers)) | async_buffer() | to_vector();
+    EXPECT_EQ(7, *moved[0]);
+}
+
+TEST(StreamAsyncBufferTest, CopiesOnlyBeforeProducerStarts) {
+    using Source = internal::ContainerGenerator<std::vector<int>>;
+    internal::AsyncBufferGenerator<Source> gen(Source(std::vector<int>({1, 2, 3})), 2);
+    internal::AsyncBufferGenerator<Source> copy(gen);
+
+    EXPECT_EQ(1, gen().value());
+    EXPECT_THROW(internal::AsyncBufferGenerator<Source> late_copy(gen), std::logic_error);
+    EXPECT_EQ(SizeHint::exact(3), copy.size_hint());
+    EXPECT_EQ(1, copy().value());
+}
+
+TEST(StreamChannelTest, ProducersFeedStream) {
+    long expected = 4 * 2 * (2500L * 2501 / 2);
+
+    EXPECT_EQ(expected, sum_from_producers<park_wait>(4, 5000));
+    EXPECT_EQ(expected, sum_from_producers<spin_wait>(4, 5000));
+#ifdef CPPSTREAM_FUTEX
+    EXPECT_EQ(expected, sum_from_producers<futex_wait>(4, 5000));
+#endif
+}
+
+TEST(StreamChannelTest, CloseEndsStream) {
+    channel<std::unique_ptr<int>> pointers(4);
+
+    EXPECT_EQ(4, pointers.capacity());
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(pointers.try_push(std::make_unique<int>(i)));
+    }
+    EXPECT_FALSE(pointers.try_push(std::make_unique<int>(4)));
+    std::unique_ptr<int> first = pointers.try_pop().value();
+    EXPECT_EQ(0, *first);
+    pointers.close();
+
+    EXPECT_TRUE(pointers.closed());
+    EXPECT_FALSE(pointers.push(std::make_unique<int>(5)));
+    auto rest = Stream(pointers) | map([](std::unique_ptr<int> ptr) { return *ptr; }) | to_vector();
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), rest);
+    EXPECT_FALSE(pointers.pop().has_value());
+}
+
+TEST(StreamChannelTest, ConsumerWaitsForLateProducer) {
+    channel<int, park_wait> events(2);
+    std::thread producer([&events]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for (int i = 0; i < 10; ++i) {
+            events.push(i);
+        }
+        events.close();
+    });
+
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), Stream(events) | to_vector());
+    producer.join();
+}
+
+TEST(StreamWindowTest, SlidingAndTumblingSpans) {
+    Stream s(1, 2, 3, 4, 5, 6, 7);
+    auto to_vectors = [](span<const int> window) { return std::vector<int>(window.begin(), window.end()); };
+
+    auto sliding = s | window(3) | map(to_vectors) | to_vector();
+    EXPECT_EQ(std::vector<std::vector<int>>({{1, 2, 3}, {2, 3, 4}, {3, 4, 5}, {4, 5, 6}, {5, 6, 7}}), sliding);
+
+    auto stepped = s | window(3, 2) | map(to_vectors) | to_vector();
+    EXPECT_EQ(std::vector<std::vector<int>>({{1, 2, 3}, {3, 4, 5}, {5, 6, 7}}), stepped);
+
+    auto tumbling = s | window(3, 3) | map(to_vectors) | to_vector();
+    EXPECT_EQ(std::vector<std::vector<int>>({{1, 2, 3}, {4, 5, 6}}), tumbling);
+
+    auto gapped = s | window(2, 3) | map(to_vectors) | to_vector();
+    EXPECT_EQ(std::vector<std::vector<int>>({{1, 2}, {4, 5}}), gapped);
+
+    EXPECT_EQ(SizeHint::exact(5), (s | window(3)).size_hint());
+    EXPECT_EQ(0, s | window(8) | count());
+
+    Stream infinite([i = 0]() mutable { return i++; });
+    auto sums = infinite | window(4, 2) | map([](span<const int> w) { return std::accumulate(w.begin(), w.end(), 0); })
+                | get(3) | to_vector();
+    EXPECT_EQ(std::vector<int>({6, 14, 22}), sums);
+}
+
+TEST(StreamWindowTest, IncrementalAggregates) {
+    std::vector<int> values{5, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9};
+    const size_t size = 4;
+    auto naive = [&](size_t step, auto aggregate) {
+        std::vector<decltype(aggregate(values.begin(), values.end()))> result;
+        for (size_t first = 0; first + size <= values.size(); first += step) {
+            result.push_back(aggregate(values.begin() + first, values.begin() + first + size));
+        }
+        return result;
+    };
+    auto sum_of = [](auto first, auto last) { return std::accumulate(first, last, 0LL); };
+    auto mean_of = [](auto first, auto last) { return std::accumulate(first, last, 0) / 4.0; };
+    auto min_of = [](auto first, auto last) { return *std::min_element(first, last); };
+    auto max_of = [](auto first, auto last) { return *std::max_element(first, last); };
+    auto digits_of = [](auto first, auto last) {
+        std::string digits;
+        for (; first != last; ++first) {
+            digits += std::to_string(*first);
+        }
+        return digits;
+    };
+
+    for (size_t step : {1, 2, 3, 5}) {
+        Stream s(values);
+        EXPECT_EQ(naive(step, sum_of), s | window(size, step, moving_sum()) | to_vector());
+        EXPECT_EQ(naive(step, mean_of), s | window(size, step, moving_mean()) | to_vector());
+        EXPECT_EQ(naive(step, min_of), s | window(size, step, moving_min()) | to_vector());
+        EXPECT_EQ(naive(step, max_of), s | window(size, step, moving_max()) | to_vector());
+        auto digits = s
+                      | map([](int i) { return std::to_string(i); })
+                      | window(size, step, moving_reduce([](const std::string & a, const std::string & b) {
+                          return a + b;
+                      }))
+                      | to_vector();
+        EXPECT_EQ(naive(step, digits_of), digits);
+    }
+
+    Stream ticks([i = 0]() mutable { return static_cast<double>(i++ % 10); });
+    EXPECT_EQ(std::vector<double>({4.5, 4.5, 4.5}), ticks | window(10000, 1, moving_mean()) | get(3) | to_vector());
+}
+
+TEST(StreamWindowTest, SumsOfIntegersDoNotOverflow) {
+    const int max = std::numeric_limits<int>::max();
+    Stream s(max, max - 1, max - 2, max - 3, max - 4);
+
+    EXPECT_EQ(std::vector<long long>({3LL * max - 3, 3LL * max - 6, 3LL * max - 9}),
+              s | window(3, 1, moving_sum()) | to_vector());
+    EXPECT_EQ(std::vector<double>({max - 1.0, max - 2.0, max - 3.0}), s | window(3, 1, moving_mean()) | to_vector());
+    Stream bytes(std::vector<uint8_t>({200, 250, 255}));
+    EXPECT_EQ(std::vector<unsigned long long>({450, 505}), bytes | window(2, 1, moving_sum()) | to_vector());
+}
+
+TEST(StreamSortTest, TopK) {
+    std::vector<int> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back((i * 7919) % 1009);
+    }
+    std::vector<int> ascending = values;
+    std::sort(ascending.begin(), ascending.end());
+    Stream s(values);
+
+    EXPECT_EQ(std::vector<int>(ascending.rbegin(), ascending.rbegin() + 10), s | top_k(10));
+    EXPECT_EQ(std::vector<int>(ascending.begin(), ascending.begin() + 5), s | top_k(5, std::less<>()));
+    EXPECT_EQ(std::vector<int>(ascending.rbegin(), ascending.rend()), s | top_k(5000));
+    EXPECT_TRUE((s | top_k(0)).empty());
+    EXPECT_EQ(std::vector<int>({9, 8}), Stream(1, 9, 3, 8) | top_k(2));
+}
+
+TEST(StreamSortTest, SortedSpillsRunsAndMergesStably) {
+    struct Record {
+        int key;
+        int position;
+
+        bool operator==(const Record & other) const { return key == other.key && position == other.position; }
+    };
+    std::vector<Record> records;
+    for (int i = 0; i < 1000; ++i) {
+        records.push_back({(i * 7919) % 101, i});
+    }
+    auto by_key = [](const Record & lhs, const Record & rhs) { return lhs.key < rhs.key; };
+    std::vector<Record> expected = records;
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    Stream s(records);
+
+    // 63 runs of 16 elements, merged at once
+    auto spilled = s | sorted(by_key, 16 * sizeof(Record));
+    EXPECT_EQ(SizeHint::exact(1000), spilled.size_hint());
+    EXPECT_EQ(expected, spilled | to_vector());
+    EXPECT_EQ(expected, s | sorted(by_key) | to_vector());
+    // 1000 runs of one element, merged in groups of max_merge_fan_in over two passes
+    EXPECT_EQ(expected, s | sorted(by_key, sizeof(Record)) | to_vector());
+    EXPECT_EQ(std::vector<Record>(expected.begin(), expected.begin() + 3),
+              s | sorted(by_key, 1) | get(3) | to_vector());
+    EXPECT_EQ(std::vector<int>({9, 8, 3, 1}), Stream(1, 9, 3, 8) | sorted(std::greater<>(), 1) | to_vector());
+    EXPECT_TRUE((Stream(std::vector<int>()) | sorted() | to_vector()).empty());
+
+    // More runs than a process may open files, all kept in one temporary file
+    std::vector<int> many(5000);
+    std::iota(many.rbegin(), many.rend(), 0);
+    std::vector<int> ascending(many.rbegin(), many.rend());
+    EXPECT_EQ(ascending, Stream(view(many)) | sorted(std::less<>(), 2 * sizeof(int)) | to_vector());
+}
+
+TEST(StreamSortTest, SortedKeepsElementsWhichCannotSpillInMemory) {
+    std::vector<std::string> words = {"pear", "fig", "apple", "kiwi", "banana"};
+    std::vector<std::string> expected = words;
+    std::sort(expected.begin(), expected.end());
+
+    EXPECT_EQ(expected, Stream(words) | sorted(std::less<>(), 1) | to_vector());
+}
+
+TEST(StreamGroupByTest, AggregatesByKeyInOrderOfFirstElements) {
+    Stream words(std::vector<std::string>({"pear", "fig", "plum", "apple", "kiwi", "peach", "avocado"}));
+    auto first_letter = [](const std::string & word) { return word[0]; };
+
+    using Counts = std::vector<std::pair<char, size_t>>;
+    EXPECT_EQ(Counts({{'p', 3}, {'f', 1}, {'a', 2}, {'k', 1}}), words | group_by(first_letter, counting()));
+    EXPECT_EQ(Counts({{'p', 13}, {'f', 3}, {'a', 12}, {'k', 4}}),
+              words | group_by(first_letter, summing([](const std::string & word) { return word.size(); })));
+    auto collected = words | group_by(first_letter);
+    ASSERT_EQ(4, collected.size());
+    EXPECT_EQ(std::vector<std::string>({"pear", "plum", "peach"}), collected[0].second);
+    auto joined = words | group_by([](const std::string & word) { return word.size(); },
+                                   reducing(std::string(), [](std::string lhs, const std::string & rhs) {
+                                       return lhs + rhs;
+                                   }));
+    using Joined = std::vector<std::pair<size_t, std::string>>;
+    EXPECT_EQ(Joined({{4, "pearplumkiwi"}, {3, "fig"}, {5, "applepeach"}, {7, "avocado"}}), joined);
+    EXPECT_TRUE((Stream(std::vector<int>()) | group_by([](int i) { return i; }, summing())).empty());
+}
+
+TEST(StreamGroupByTest, ManyKeysCollidingHashesAndParallelParts) {
+    std::vector<int> values(100000);
+    std::iota(values.begin(), values.end(), 0);
+    auto key = [](int i) { return (i * 7919) % 20011; };
+    std::vector<std::pair<int, long>> expected;
+    std::unordered_map<int, size_t> positions;
+    for (int i : values) {
+        auto inserted = positions.emplace(key(i), expected.size());
+        if (inserted.second) {
+            expected.emplace_back(key(i), 0);
+        }
+        expected[inserted.first->second].second += i;
+    }
+    Stream s(values);
+    auto by_key = [&key](int i) -> long { return key(i); };
+    auto sums = [](auto && groups) {
+        std::vector<std::pair<int, long>> result;
+        for (auto & group : groups) {
+            result.emplace_back(static_cast<int>(group.first), group.second);
+        }
+        return result;
+    };
+
+    EXPECT_EQ(expected, sums(s | map([](int i) -> long { return i; }) | group_by(by_key, summing())));
+    EXPECT_EQ(expected, sums(s | par(4) | group_by(key, summing([](int i) -> long { return i; }))));
+
+    // First 500 elements have distinct keys, all of them colliding in the table
+    std::vector<std::pair<int, long>> few_expected;
+    for (int i = 0; i < 500; ++i) {
+        few_expected.emplace_back(key(i), i);
+    }
+    auto constant_hash = [](int unused) { return size_t(42); };
+    auto few_sums = s | get(500) | group_by(key, summing([](int i) -> long { return i; }), constant_hash);
+    EXPECT_EQ(few_expected, sums(few_sums));
+}
+
+TEST(StreamGroupByTest, AggregateByStage) {
+    Stream s(3, 1, 3, 2, 1, 3);
+    auto counts = s | aggregate_by([](int i) { return i; }, counting());
+    EXPECT_EQ(SizeHint::upper_bound(6), counts.size_hint());
+    using Counts = std::vector<std::pair<int, size_t>>;
+    EXPECT_EQ(Counts({{3, 3}, {2, 1}}), counts | filter([](const auto & group) { return group.first > 1; }) | to_vector());
+    EXPECT_EQ(3, counts | count());
+}
+
 }